@@ -11,6 +11,8 @@ cd ${result_directory%/ipc-bench*}/ipc-bench/build/source
 
 technologies=(
 		shm
+		shm-ring
+		shm-sync
 		mq
 		domain
 		fifo
@@ -25,19 +27,20 @@ if [ $(uname) = Linux ]; then
 		technologies+=( eventfd-uni )
 fi
 
-for tech in $technologies; do
+for tech in "${technologies[@]}"; do
 		echo "Running $tech ..."
 		cd $tech
 
-		if [ -f output/$tech.result ]; then
-				rm $output/$tech.result
+		if [ -f $output/$tech.jsonl ]; then
+				rm $output/$tech.jsonl
 		fi
 
 		for size_power in $(seq 0 3); do
 				size=$((10**size_power))
 				for count_power in $(seq 0 3); do
 						count=$((10**count_power))
-						./$tech -s $size -c $count >> "$output/$tech.result"
+						# One JSON record per line, ready for import
+						./$tech -s $size -c $count --format json >> "$output/$tech.jsonl"
 						if [ $tech = zeromq ]; then
 								sleep 0.2
 						else
@@ -53,4 +56,30 @@ for tech in $technologies; do
 		cd ..
 done
 
+# Large messages from 64KB to 16MB, where the copy of send() dominates,
+# with copying and zero-copy sends (about 256MB per run)
+for variant in "tcp" "tcp --zerocopy" "domain"; do
+		tech=${variant%% *}
+		# e.g. tcp-zerocopy
+		name=${variant// --/-}
+		echo "Running $variant with large messages ..."
+		cd $tech
+
+		if [ -f $output/$name-large.jsonl ]; then
+				rm $output/$name-large.jsonl
+		fi
+
+		for size_power in $(seq 16 2 24); do
+				size=$((2**size_power))
+				count=$((2**28 / size))
+				./$variant -s $size -c $count --format json >> "$output/$name-large.jsonl"
+				sleep 0.1
+		done
+
+		killall -9 "$tech-server" &> /dev/null
+		killall -9 "$tech-client" &> /dev/null
+
+		cd ..
+done
+
 cd $result_directory
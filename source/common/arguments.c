@@ -1,88 +1,298 @@
 #include <getopt.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #include "common/arguments.h"
+#include "common/benchmarks.h"
+#include "common/guard.h"
+#include "common/results.h"
+#include "common/stream.h"
+#include "common/utility.h"
 
 #define true 1
 #define false 0
 
+// Codes for options that only have a long form
+enum {
+	CLOCK_OPTION = 256,
+	FORMAT_OPTION,
+	WARMUP_OPTION,
+	STEADY_OPTION,
+	SERVER_CPU_OPTION,
+	CLIENT_CPU_OPTION,
+	WAIT_OPTION,
+	MODE_OPTION,
+	PERF_OPTION
+};
+
 void print_usage() {
 	printf(
 			"Usage: fifos "
 			"-s/--size <bytes> "
-			"-c/--count <number>"
+			"-c/--count <number> "
+			"--clock <auto|tsc|rdcycle|rdtime|monotonic> "
+			"--format <text|json|csv|csv-noheader> "
+			"--warmup <number|<ms>ms> "
+			"--steady <cv> "
+			"--server-cpu <cpu> "
+			"--client-cpu <cpu> "
+			"--wait <spin|futex|hybrid[:<spins>]> "
+			"--mode <pingpong|stream|window:<messages>> "
+			"--perf"
 			"\n");
 	exit(EXIT_FAILURE);
 }
 
+// The "-server" or "-client" suffix of the program name (or "")
+static const char *program_role(const char *program) {
+	const char *name = strrchr(program, '/');
+	size_t length;
+
+	name = (name == NULL) ? program : name + 1;
+	length = strlen(name);
+
+	if (length > 7 && (strcmp(name + length - 7, "-server") == 0 ||
+										 strcmp(name + length - 7, "-client") == 0)) {
+		return name + length - 7;
+	}
+
+	return name + length;
+}
+
+static void set_transport_name(Arguments *arguments, const char *program) {
+	const char *name = strrchr(program, '/');
+	const char *role = program_role(program);
+	size_t length;
+
+	name = (name == NULL) ? program : name + 1;
+
+	// shm-server and shm-client both belong to the shm transport
+	length = role - name;
+	if (length >= sizeof arguments->transport) {
+		length = sizeof arguments->transport - 1;
+	}
+
+	memcpy(arguments->transport, name, length);
+	arguments->transport[length] = '\0';
+}
+
+static int parse_cpu(const char *value) {
+	char *end;
+	long cpu = strtol(value, &end, 10);
+
+	if (end == value || *end != '\0' || cpu < 0) {
+		terminate("Invalid CPU, use the number of a logical CPU\n");
+	}
+
+	// Fail before any process is started, rather than in one of the peers
+	if (!cpu_allowed(cpu)) {
+		terminate("CPU does not exist or is not allowed for this process\n");
+	}
+
+	return cpu;
+}
+
+static void pin_role(const Arguments *arguments, const char *program) {
+	const char *role = program_role(program);
+
+	// Children started by start_children() are already pinned,
+	// this covers starting a server or client on its own
+	if (strcmp(role, "-server") == 0) {
+		pin_thread(arguments->server_cpu);
+	} else if (strcmp(role, "-client") == 0) {
+		pin_thread(arguments->client_cpu);
+	}
+}
+
+static void parse_warmup(Arguments *arguments, const char *value) {
+	char *unit;
+	long amount = strtol(value, &unit, 10);
+
+	if (unit == value || amount < 0) {
+		terminate("Invalid warmup, use a message count or a duration like 100ms\n");
+	}
+
+	if (strcmp(unit, "ms") == 0) {
+		arguments->warmup_ms = amount;
+	} else if (*unit == '\0') {
+		arguments->warmup = amount;
+	} else {
+		terminate("Invalid warmup unit, use a plain count or ms\n");
+	}
+}
+
+static void parse_wait(Arguments *arguments, const char *value) {
+	char *end;
+
+	arguments->spin_count = DEFAULT_SPIN_COUNT;
+
+	if (strcmp(value, "spin") == 0) {
+		arguments->wait = WAIT_SPIN;
+	} else if (strcmp(value, "futex") == 0) {
+		arguments->wait = WAIT_FUTEX;
+	} else if (strncmp(value, "hybrid", 6) == 0) {
+		arguments->wait = WAIT_HYBRID;
+		if (value[6] == ':') {
+			arguments->spin_count = strtol(value + 7, &end, 10);
+			if (end == value + 7 || *end != '\0' || arguments->spin_count < 0) {
+				terminate("Invalid spin count, use e.g. hybrid:1000\n");
+			}
+		} else if (value[6] != '\0') {
+			terminate("Unknown wait mode, use one of spin, futex, hybrid[:<spins>]\n");
+		}
+	} else {
+		terminate("Unknown wait mode, use one of spin, futex, hybrid[:<spins>]\n");
+	}
+}
+
+static void parse_mode(Arguments *arguments, const char *value) {
+	char *end;
+
+	arguments->window = 0;
+
+	if (strcmp(value, "pingpong") == 0) {
+		arguments->mode = MODE_PINGPONG;
+	} else if (strcmp(value, "stream") == 0) {
+		arguments->mode = MODE_STREAM;
+	} else if (strncmp(value, "window:", 7) == 0) {
+		arguments->mode = MODE_WINDOW;
+		arguments->window = strtol(value + 7, &end, 10);
+		if (end == value + 7 || *end != '\0' || arguments->window <= 0) {
+			terminate("Invalid window, use e.g. window:16\n");
+		}
+	} else {
+		terminate("Unknown mode, use one of pingpong, stream, window:<messages>\n");
+	}
+}
+
 void parse_arguments(Arguments *arguments, int argc, char *argv[]) {
 	// For getopt long options
 	int long_index = 0;
 	// For getopt chars
 	int option;
 
-	// Reset the option index to 1 if it
-	// was modified before (e.g. in check_flag)
+	// Reset the option index in case
+	// getopt was used before
 	optind = 0;
 
 	// Default values
 	arguments->size = DEFAULT_MESSAGE_SIZE;
 	arguments->count = 1000;
+	arguments->clock = CLOCK_SOURCE_AUTO;
+	arguments->format = FORMAT_TEXT;
+	arguments->warmup = 0;
+	arguments->warmup_ms = 0;
+	arguments->steady = 0;
+	arguments->server_cpu = -1;
+	arguments->client_cpu = -1;
+	arguments->wait = WAIT_SPIN;
+	arguments->spin_count = DEFAULT_SPIN_COUNT;
+	arguments->mode = MODE_PINGPONG;
+	arguments->window = 0;
+	arguments->clients = 1;
+	arguments->client = -1;
+	arguments->rate = 0;
+	arguments->poisson = 0;
+	arguments->perf = false;
+	set_transport_name(arguments, argv[0]);
 
 	// Command line arguments
 	// clang-format off
 	static struct option long_options[] = {
 			{"size",  required_argument, NULL, 's'},
 			{"count", required_argument, NULL, 'c'},
+			{"clock", required_argument, NULL, CLOCK_OPTION},
+			{"format", required_argument, NULL, FORMAT_OPTION},
+			{"warmup", required_argument, NULL, WARMUP_OPTION},
+			{"steady", required_argument, NULL, STEADY_OPTION},
+			{"server-cpu", required_argument, NULL, SERVER_CPU_OPTION},
+			{"client-cpu", required_argument, NULL, CLIENT_CPU_OPTION},
+			{"wait", required_argument, NULL, WAIT_OPTION},
+			{"mode", required_argument, NULL, MODE_OPTION},
+			{"perf", no_argument, NULL, PERF_OPTION},
 			{0,       0,                 0,     0}
 	};
 	// clang-format on
 
-	while (true) {
-		option = getopt_long(argc, argv, "+:s:c:", long_options, &long_index);
-
+	// clang-format off
+	while ((option = getopt_long(
+						argc, argv, "+:s:c:", long_options, &long_index)) != -1) {
+		// clang-format on
 		switch (option) {
-			case -1: return;
 			case 's': arguments->size = atoi(optarg); break;
 			case 'c': arguments->count = atoi(optarg); break;
+			case CLOCK_OPTION: arguments->clock = parse_clock(optarg); break;
+			case FORMAT_OPTION: arguments->format = parse_format(optarg); break;
+			case WARMUP_OPTION: parse_warmup(arguments, optarg); break;
+			case STEADY_OPTION: arguments->steady = atof(optarg); break;
+			case SERVER_CPU_OPTION: arguments->server_cpu = parse_cpu(optarg); break;
+			case CLIENT_CPU_OPTION: arguments->client_cpu = parse_cpu(optarg); break;
+			case WAIT_OPTION: parse_wait(arguments, optarg); break;
+			case MODE_OPTION: parse_mode(arguments, optarg); break;
+			case PERF_OPTION: arguments->perf = true; break;
 			default: continue;
 		}
 	}
+
+	// Pin before calibrating, the counter may differ between CPUs
+	pin_role(arguments, argv[0]);
+
+	setup_clock(arguments->clock);
+	setup_warmup(arguments);
+	setup_perf(arguments);
 }
 
-int check_flag(const char *flag, int argc, char *argv[]) {
-	// For getopt long options
-	int index = 0;
-	// The char returned by getopt()
-	int option;
-	// Setting the first character to be a plus
-	// prevents getopt() from reordering the vector,
-	// setting the second character to be a colon
-	// prevents getopt() from printing an error
-	// message when it encounters invalid options
-	char short_flag[3] = {'+', ':', flag[0]};
-
-	// Reset getopt index
-	optind = 0;
+int total_messages(const Arguments *args) {
+	int budget = args->warmup;
 
+	if (args->warmup_ms > 0 || args->steady > 0) {
+		budget += args->count;
+	}
+
+	return args->count + budget;
+}
+
+void reject_warmup(const Arguments *args) {
+	if (args->warmup > 0 || args->warmup_ms > 0 || args->steady > 0) {
+		terminate("This program takes no samples, --warmup and --steady are not supported\n");
+	}
+}
+
+void name_variant(Arguments *args, const char *suffix) {
 	// clang-format off
-	struct option long_options [2] = {
-		{flag, no_argument, NULL, flag[0]},
-		{0,    0,           0,    0}
-	};
+	strncat(args->transport, suffix,
+					sizeof args->transport - strlen(args->transport) - 1);
 	// clang-format on
+}
 
-	while (true) {
-		option = getopt_long(argc, argv, short_flag, long_options, &index);
+int check_flag(const char *flag, int argc, char *argv[]) {
+	int index;
 
-		if (option == flag[0]) {
+	// A plain scan rather than getopt(), which stops at the first option
+	// it does not know and would confuse e.g. "stream" with "-s <size>"
+	for (index = 1; index < argc; ++index) {
+		if (strncmp(argv[index], "--", 2) == 0 && strcmp(argv[index] + 2, flag) == 0) {
 			return true;
-		} else if (option == -1) {
-			break;
 		}
 	}
 
 	return false;
 }
+
+const char *option_value(const char *name, int argc, char *argv[]) {
+	size_t length = strlen(name);
+	int index;
+
+	// Only the "=" form, a separate value would end getopt()'s parsing
+	for (index = 1; index < argc; ++index) {
+		if (strncmp(argv[index], "--", 2) == 0 &&
+				strncmp(argv[index] + 2, name, length) == 0 &&
+				argv[index][length + 2] == '=') {
+			return argv[index] + length + 3;
+		}
+	}
+
+	return NULL;
+}
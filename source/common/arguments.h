@@ -9,10 +9,76 @@ typedef struct Arguments {
 	int size;
 	int count;
 
+	// The ClockSource used for now()
+	int clock;
+
+	// The OutputFormat of the results
+	int format;
+
+	// Minimum number of untimed warmup messages
+	int warmup;
+
+	// Minimum duration of the warmup in milliseconds
+	int warmup_ms;
+
+	// Coefficient of variation below which the warmup is steady (0 = off)
+	double steady;
+
+	// Logical CPUs to pin the server and client to (-1 = not pinned)
+	int server_cpu;
+	int client_cpu;
+
+	// The WaitMode of transports polling shared memory
+	int wait;
+
+	// Polls of the hybrid wait before it sleeps
+	int spin_count;
+
+	// The Mode of the exchange and its window (messages in flight)
+	int mode;
+	int window;
+
+	// Clients of a fan-in run of ipc-bench and the one a result
+	// is for (-1 = the whole run)
+	int clients;
+	int client;
+
+	// Open-loop request rate of ipc-bench in msg/s (0 = closed loop) and
+	// whether the requests arrive as a Poisson process instead of evenly
+	double rate;
+	int poisson;
+
+	// Whether to read performance counters around the measurement
+	int perf;
+
+	// Name of the transport, derived from the program name
+	char transport[64];
+
 } Arguments;
 
 void parse_arguments(Arguments* arguments, int argc, char* argv[]);
 
 int check_flag(const char* name, int argc, char* argv[]);
 
+// The value of a transport-specific "--name=value" option, or NULL
+const char* option_value(const char* name, int argc, char* argv[]);
+
+/**
+ * Returns the number of messages both peers must exchange.
+ *
+ * This is the message count plus the warmup budget. Time- and steady-state
+ * bounded warmups may use up to count additional messages; whatever they do
+ * not need is exchanged untimed after the measurement.
+ *
+ * \param args The parsed arguments.
+ */
+int total_messages(const Arguments* args);
+
+// Appends the name of a variant to the transport, as far as it fits
+void name_variant(Arguments* args, const char* suffix);
+
+// Terminates if a warmup was requested from a program that only times the
+// whole run, without the samples a warmup is decided on
+void reject_warmup(const Arguments* args);
+
 #endif /* IPC_BENCH_ARGUMENTS_H */
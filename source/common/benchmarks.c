@@ -2,34 +2,427 @@
 #include <math.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sys/time.h>
 #include <time.h>
 
+#if defined(__x86_64__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
 #include "common/arguments.h"
 #include "common/benchmarks.h"
+#include "common/results.h"
+#include "common/stream.h"
+#include "common/topology.h"
+#include "common/utility.h"
+
+// Fixed-point shift for converting counter ticks to nanoseconds
+#define CLOCK_SHIFT 32
+
+// Time spent calibrating a cycle counter against CLOCK_MONOTONIC_RAW
+#define CLOCK_CALIBRATION_NS 20000000ULL
+
+// Number of back-to-back now() pairs used to estimate the overhead
+#define CLOCK_OVERHEAD_SAMPLES 1001
+
+static ClockSource clock_source = CLOCK_SOURCE_MONOTONIC;
+
+// ns = ((ticks - clock_base) * clock_multiplier) >> CLOCK_SHIFT
+static bench_t clock_base;
+static bench_t clock_multiplier;
+static double frequency;
+static bench_t overhead;
+
+// Warmup configuration, see setup_warmup()
+static struct {
+	int count;
+	int minimum;
+	int budget;
+	bench_t time;
+	double steady;
+} warmup;
+
+// Whether benchmarks read performance counters, see setup_perf()
+static int perf_enabled;
+
+static inline bench_t monotonic_now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static inline bench_t read_counter() {
+#if defined(__x86_64__)
+	unsigned int aux;
+	// rdtscp waits for all prior instructions to retire, so the
+	// read is not hoisted above the operation we are timing
+	return __rdtscp(&aux);
+#elif defined(__riscv)
+	bench_t ticks;
+	if (clock_source == CLOCK_SOURCE_RDCYCLE) {
+		__asm__ __volatile__("rdcycle %0" : "=r"(ticks) : : "memory");
+	} else {
+		__asm__ __volatile__("rdtime %0" : "=r"(ticks) : : "memory");
+	}
+	return ticks;
+#else
+	return monotonic_now();
+#endif
+}
 
 bench_t now() {
-#ifdef __MACH__
-	return ((double)clock()) / CLOCKS_PER_SEC * 1e9;
+	if (clock_source == CLOCK_SOURCE_MONOTONIC) {
+		return monotonic_now();
+	}
+
+	// clang-format off
+	return (bench_t)(
+		((unsigned __int128)(read_counter() - clock_base) * clock_multiplier)
+		>> CLOCK_SHIFT
+	);
+	// clang-format on
+}
+
+static void check_clock_source(ClockSource source) {
+	switch (source) {
+#if defined(__x86_64__)
+		case CLOCK_SOURCE_TSC: {
+			unsigned int eax, ebx, ecx, edx;
+			// CPUID 0x80000007 EDX bit 8: the TSC ticks at a constant
+			// rate across P-, C- and T-states
+			if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) ||
+					!(edx & (1 << 8))) {
+				warn("TSC is not invariant, results may be skewed by frequency scaling");
+			}
+			return;
+		}
+#elif defined(__riscv)
+		case CLOCK_SOURCE_RDCYCLE:
+		case CLOCK_SOURCE_RDTIME: return;
+#endif
+		case CLOCK_SOURCE_MONOTONIC: return;
+		default: terminate("The requested clock is not available on this architecture\n");
+	}
+}
+
+static void calibrate_counter() {
+	bench_t start_ticks, end_ticks;
+	bench_t start_ns, end_ns;
+
+	// Busy-wait rather than sleep so that we do not
+	// calibrate across a context switch or idle state
+	start_ns = monotonic_now();
+	start_ticks = read_counter();
+	do {
+		end_ns = monotonic_now();
+	} while (end_ns - start_ns < CLOCK_CALIBRATION_NS);
+	end_ticks = read_counter();
+
+	frequency = (double)(end_ticks - start_ticks) / (end_ns - start_ns);
+	if (frequency <= 0) {
+		terminate("Clock counter did not advance during calibration\n");
+	}
+
+	clock_multiplier = (bench_t)((1ULL << CLOCK_SHIFT) / frequency);
+	clock_base = end_ticks;
+}
+
+static int compare_bench(const void* first, const void* second) {
+	const bench_t a = *(const bench_t*)first;
+	const bench_t b = *(const bench_t*)second;
+
+	return (a > b) - (a < b);
+}
+
+static void measure_overhead() {
+	bench_t samples[CLOCK_OVERHEAD_SAMPLES];
+	bench_t start;
+	int index;
+
+	overhead = 0;
+	for (index = 0; index < CLOCK_OVERHEAD_SAMPLES; ++index) {
+		start = now();
+		samples[index] = now() - start;
+	}
+
+	// The median is robust against the occasional interrupt
+	qsort(samples, CLOCK_OVERHEAD_SAMPLES, sizeof samples[0], compare_bench);
+	overhead = samples[CLOCK_OVERHEAD_SAMPLES / 2];
+}
+
+void setup_clock(ClockSource source) {
+	if (source == CLOCK_SOURCE_AUTO) {
+#if defined(__x86_64__)
+		source = CLOCK_SOURCE_TSC;
+#elif defined(__riscv)
+		source = CLOCK_SOURCE_RDTIME;
 #else
+		source = CLOCK_SOURCE_MONOTONIC;
+#endif
+	}
+
+	check_clock_source(source);
+	clock_source = source;
+	frequency = 0;
+
+	if (source != CLOCK_SOURCE_MONOTONIC) {
+		calibrate_counter();
+	}
+
+	measure_overhead();
+}
+
+ClockSource parse_clock(const char* name) {
+	if (strcmp(name, "auto") == 0) return CLOCK_SOURCE_AUTO;
+	if (strcmp(name, "tsc") == 0) return CLOCK_SOURCE_TSC;
+	if (strcmp(name, "rdcycle") == 0) return CLOCK_SOURCE_RDCYCLE;
+	if (strcmp(name, "rdtime") == 0) return CLOCK_SOURCE_RDTIME;
+	if (strcmp(name, "monotonic") == 0) return CLOCK_SOURCE_MONOTONIC;
+
+	terminate("Unknown clock, use one of auto, tsc, rdcycle, rdtime, monotonic\n");
+}
+
+const char* clock_name() {
+	switch (clock_source) {
+		case CLOCK_SOURCE_TSC: return "tsc";
+		case CLOCK_SOURCE_RDCYCLE: return "rdcycle";
+		case CLOCK_SOURCE_RDTIME: return "rdtime";
+		default: return "monotonic";
+	}
+}
+
+double clock_frequency() {
+	return frequency;
+}
+
+bench_t clock_overhead() {
+	return overhead;
+}
+
+static inline int histogram_index(bench_t value) {
+	// Position of the most significant bit (value | 1 keeps clz defined)
+	const int magnitude = 63 - __builtin_clzll(value | 1);
+	int shift = 0;
+
+	if (magnitude > HISTOGRAM_SUB_BITS) {
+		shift = magnitude - HISTOGRAM_SUB_BITS;
+	}
+
+	// The top HISTOGRAM_SUB_BITS + 1 bits select the sub-bucket,
+	// the shift selects the power of two the sub-bucket belongs to
+	return (shift << HISTOGRAM_SUB_BITS) + (int)(value >> shift);
+}
+
+static bench_t histogram_upper_bound(int index) {
+	int shift;
+	bench_t mantissa;
+
+	if (index < 2 * HISTOGRAM_SUB_COUNT) {
+		return index;
+	}
+
+	shift = (index >> HISTOGRAM_SUB_BITS) - 1;
+	mantissa = index - (shift << HISTOGRAM_SUB_BITS);
+
+	return ((mantissa + 1) << shift) - 1;
+}
+
+void histogram_record(Histogram* histogram, bench_t value) {
+	++histogram->buckets[histogram_index(value)];
+	++histogram->count;
+}
+
+bench_t histogram_percentile(const Histogram* histogram, double percentile) {
+	bench_t rank;
+	bench_t seen = 0;
+	int index;
+
+	if (histogram->count == 0) return 0;
+
+	// The rank of the sample we are looking for (1-based)
+	rank = (bench_t)ceil(percentile / 100.0 * histogram->count);
+	if (rank == 0) rank = 1;
+
+	for (index = 0; index < HISTOGRAM_BUCKETS; ++index) {
+		seen += histogram->buckets[index];
+		if (seen >= rank) {
+			return histogram_upper_bound(index);
+		}
+	}
+
+	return histogram_upper_bound(HISTOGRAM_BUCKETS - 1);
+}
+
+static bench_t cpu_time() {
 	struct timespec ts;
-	timespec_get(&ts, TIME_UTC);
 
-	return ts.tv_sec * 1e9 + ts.tv_nsec;
+	// User and system time of the measuring thread only, so that clients
+	// running as threads of one process are not charged for each other
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == -1) {
+		throw("Error reading CPU time");
+	}
 
-#endif
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+void setup_warmup(Arguments* args) {
+	warmup.count = args->count;
+	warmup.minimum = args->warmup;
+	warmup.budget = total_messages(args) - args->count;
+	warmup.time = args->warmup_ms * 1000000ULL;
+	warmup.steady = args->steady;
+}
+
+void setup_perf(Arguments* args) {
+	perf_enabled = args->perf;
+}
+
+static void start_counters(Benchmarks* bench) {
+	int side;
+
+	usage_read(0, &bench->usage[PERF_SELF]);
+	if (bench->peer > 0 && !usage_read(bench->peer, &bench->usage[PERF_PEER])) {
+		bench->peer = 0;
+	}
+
+	for (side = 0; side < PERF_SIDES; ++side) {
+		perf_start(&bench->perf[side]);
+	}
+}
+
+static void stop_counters(Benchmarks* bench) {
+	CpuUsage end;
+	int side;
+
+	for (side = 0; side < PERF_SIDES; ++side) {
+		perf_stop(&bench->perf[side]);
+	}
+
+	usage_read(0, &end);
+	usage_subtract(&end, &bench->usage[PERF_SELF]);
+	bench->usage[PERF_SELF] = end;
+
+	// The peer may be gone already if it did not wait for us
+	if (bench->peer > 0 && usage_read(bench->peer, &end)) {
+		usage_subtract(&end, &bench->usage[PERF_PEER]);
+		bench->usage[PERF_PEER] = end;
+	} else {
+		bench->peer = 0;
+	}
 }
 
 void setup_benchmarks(Benchmarks* bench) {
-	bench->minimum = INT32_MAX;
+	bench->minimum = UINT64_MAX;
 	bench->maximum = 0;
 	bench->sum = 0;
-	bench->squared_sum = 0;
+	memset(&bench->histogram, 0, sizeof bench->histogram);
+
+	bench->warmup_messages = 0;
+	bench->window_sum = 0;
+	bench->window_squared_sum = 0;
+	bench->phase = (warmup.budget > 0) ? PHASE_WARMUP : PHASE_MEASURE;
+
+	bench->peer = 0;
+	perf_clear(&bench->perf[PERF_SELF]);
+	perf_clear(&bench->perf[PERF_PEER]);
+	if (perf_enabled) {
+		perf_open(&bench->perf[PERF_SELF], 0);
+	}
+
+	// Read before the clocks, so that reading does not count as measured
+	start_counters(bench);
+	bench->cpu_start = cpu_time();
+	bench->total_start = now();
+	bench->warmup_start = bench->total_start;
+}
+
+void benchmarks_start(Benchmarks* bench) {
+	setup_benchmarks(bench);
+	bench->phase = PHASE_MEASURE;
+}
+
+void benchmarks_stop(Benchmarks* bench) {
+	if (bench->phase == PHASE_DONE) return;
+
+	bench->total_end = now();
+	bench->cpu_end = cpu_time();
+	stop_counters(bench);
+	bench->phase = PHASE_DONE;
+}
+
+void benchmarks_count_peer(Benchmarks* bench, pid_t peer) {
+	if (!usage_read(peer, &bench->usage[PERF_PEER])) return;
+	bench->peer = peer;
+
+	if (perf_enabled) {
+		perf_open(&bench->perf[PERF_PEER], peer);
+		perf_start(&bench->perf[PERF_PEER]);
+	}
+}
+
+static int is_steady(Benchmarks* bench) {
+	double mean, variance;
+
+	if (warmup.steady <= 0) return true;
+	if (bench->warmup_messages < WARMUP_WINDOW) return false;
+
+	mean = bench->window_sum / WARMUP_WINDOW;
+	variance = bench->window_squared_sum / WARMUP_WINDOW - mean * mean;
+	if (variance < 0) variance = 0;
+
+	return mean > 0 && sqrt(variance) / mean < warmup.steady;
+}
+
+static void warm_up(Benchmarks* bench, bench_t time) {
+	bench_t* slot = &bench->window[bench->warmup_messages % WARMUP_WINDOW];
+
+	// Slide the window over the latest samples
+	if (bench->warmup_messages >= WARMUP_WINDOW) {
+		bench->window_sum -= *slot;
+		bench->window_squared_sum -= (double)*slot * *slot;
+	}
+	*slot = time;
+	bench->window_sum += time;
+	bench->window_squared_sum += (double)time * time;
+	++bench->warmup_messages;
+
+	if (bench->warmup_messages < warmup.budget) {
+		if (bench->warmup_messages < warmup.minimum) return;
+		if (now() - bench->warmup_start < warmup.time) return;
+		if (!is_steady(bench)) return;
+	} else {
+		if (now() - bench->warmup_start < warmup.time) {
+			warn("Warmup budget used up before the warmup time, measuring anyway");
+		}
+		if (warmup.steady > 0 && !is_steady(bench)) {
+			warn("No steady state within the warmup budget, measuring anyway");
+		}
+	}
+
+	bench->phase = PHASE_MEASURE;
+	start_counters(bench);
+	bench->cpu_start = cpu_time();
 	bench->total_start = now();
 }
 
 void benchmark(Benchmarks* bench) {
-	const bench_t time = now() - bench->single_start;
+	benchmark_sample(bench, now() - bench->single_start);
+}
+
+void benchmark_sample(Benchmarks* bench, bench_t time) {
+	// Don't charge the cost of reading the clock to the transport
+	time = (time > overhead) ? time - overhead : 0;
+
+	if (bench->phase != PHASE_MEASURE) {
+		if (bench->phase == PHASE_WARMUP) {
+			warm_up(bench, time);
+		}
+		return;
+	}
 
 	if (time < bench->minimum) {
 		bench->minimum = time;
@@ -40,27 +433,132 @@ void benchmark(Benchmarks* bench) {
 	}
 
 	bench->sum += time;
-	bench->squared_sum += (time * time);
+	histogram_record(&bench->histogram, time);
+
+	if (bench->histogram.count == (bench_t)warmup.count) {
+		benchmarks_stop(bench);
+	}
 }
 
-void evaluate(Benchmarks* bench, Arguments* args) {
+void benchmarks_merge(Benchmarks* into, const Benchmarks* from) {
+	benchmarks_merge_samples(into, from);
+	benchmarks_merge_usage(into, from);
+}
+
+void benchmarks_merge_samples(Benchmarks* into, const Benchmarks* from) {
+	int index;
+
+	if (from->minimum < into->minimum) into->minimum = from->minimum;
+	if (from->maximum > into->maximum) into->maximum = from->maximum;
+	into->sum += from->sum;
+
+	into->histogram.count += from->histogram.count;
+	for (index = 0; index < HISTOGRAM_BUCKETS; ++index) {
+		into->histogram.buckets[index] += from->histogram.buckets[index];
+	}
+
+	into->warmup_messages += from->warmup_messages;
+}
+
+void benchmarks_merge_usage(Benchmarks* into, const Benchmarks* from) {
+	into->cpu_end += from->cpu_end - from->cpu_start;
+
+	perf_merge(&into->perf[PERF_SELF], &from->perf[PERF_SELF]);
+	perf_merge(&into->perf[PERF_PEER], &from->perf[PERF_PEER]);
+
+	usage_add(&into->usage[PERF_SELF], &from->usage[PERF_SELF]);
+	if (from->peer > 0) {
+		if (into->peer > 0) {
+			usage_add(&into->usage[PERF_PEER], &from->usage[PERF_PEER]);
+		} else {
+			into->usage[PERF_PEER] = from->usage[PERF_PEER];
+			into->peer = from->peer;
+		}
+	}
+}
+
+void summarize(Benchmarks* bench, Arguments* args, Results* results) {
 	assert(args->count > 0);
-	const bench_t total_time = now() - bench->total_start;
-	const double average = ((double)bench->sum) / args->count;
-
-	double sigma = bench->squared_sum / args->count;
-	sigma = sqrt(sigma - (average * average));
-
-	int messageRate = (int)(args->count / (total_time / 1e9));
-
-	printf("\n============ RESULTS ================\n");
-	printf("Message size:       %d\n", args->size);
-	printf("Message count:      %d\n", args->count);
-	printf("Total duration:     %.3f\tms\n", total_time / 1e6);
-	printf("Average duration:   %.3f\tus\n", average / 1000.0);
-	printf("Minimum duration:   %.3f\tus\n", bench->minimum / 1000.0);
-	printf("Maximum duration:   %.3f\tus\n", bench->maximum / 1000.0);
-	printf("Standard deviation: %.3f\tus\n", sigma / 1000.0);
-	printf("Message rate:       %d\tmsg/s\n", messageRate);
-	printf("=====================================\n");
+	bench_t total_time;
+	int index;
+	int side;
+
+	// Transports without single benchmarks never reach PHASE_DONE
+	benchmarks_stop(bench);
+	total_time = bench->total_end - bench->total_start;
+
+	results->transport = args->transport;
+	results->size = args->size;
+	results->count = args->count;
+	results->total_time = total_time;
+	results->warmup = bench->warmup_messages;
+	results->mode = mode_name(args->mode);
+	results->window = args->window;
+	results->clients = args->clients;
+	results->client = args->client;
+	results->series = NULL;
+	results->offered_rate = args->rate;
+
+	results->samples = bench->histogram.count;
+	results->minimum = bench->minimum;
+	results->maximum = bench->maximum;
+	results->average = 0;
+	if (results->samples > 0) {
+		results->average = bench->sum / (double)results->samples;
+	}
+	for (index = 0; index < RESULT_PERCENTILES; ++index) {
+		// clang-format off
+		results->percentiles[index] = histogram_percentile(
+			&bench->histogram,
+			result_percentiles[index]
+		);
+		// clang-format on
+
+		// The bucket bound may overshoot the largest sample we actually saw
+		if (results->percentiles[index] > bench->maximum) {
+			results->percentiles[index] = bench->maximum;
+		}
+	}
+
+	results->message_rate = args->count / (total_time / 1e9);
+	results->byte_rate = results->message_rate * args->size;
+	results->cpu_time = bench->cpu_end - bench->cpu_start;
+	results->cpu_time /= args->count;
+	results->per_notification = 0;
+	results->per_receive = 0;
+	results->syscalls = -1;
+	results->copied = -1;
+
+	for (side = 0; side < PERF_SIDES; ++side) {
+		results->usage[side] = bench->usage[side];
+		usage_divide(&results->usage[side], args->count);
+	}
+	results->peer_usage = bench->peer > 0;
+
+	results->perf = args->perf;
+	for (side = 0; side < PERF_SIDES; ++side) {
+		for (index = 0; index < PERF_COUNTERS; ++index) {
+			results->counters[side][index] = bench->perf[side].counts[index];
+			if (results->counters[side][index] >= 0) {
+				results->counters[side][index] /= args->count;
+			}
+		}
+	}
+
+	results->server_cpu = args->server_cpu;
+	results->client_cpu = args->client_cpu;
+	results->relation =
+			relation_name(cpu_relation(args->server_cpu, args->client_cpu));
+
+	results->clock = clock_name();
+	results->clock_frequency = frequency;
+	results->clock_overhead = overhead;
+
+}
+
+void evaluate(Benchmarks* bench, Arguments* args) {
+	Results results;
+
+	summarize(bench, args, &results);
+	print_results(&results, args);
 }
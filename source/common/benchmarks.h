@@ -1,10 +1,62 @@
 #ifndef IPC_BENCH_BENCHMARKS_H
 #define IPC_BENCH_BENCHMARKS_H
 
+#include <sys/types.h>
+
+#include "common/perf.h"
+#include "common/usage.h"
+
 struct Arguments;
+struct Results;
 
 typedef unsigned long long bench_t;
 
+/******************** DEFINITIONS ********************/
+
+// The time source behind now(). Cycle counters are calibrated against
+// CLOCK_MONOTONIC_RAW at startup, so now() always returns nanoseconds.
+typedef enum ClockSource {
+	// The cheapest counter of the architecture (tsc, rdtime or monotonic)
+	CLOCK_SOURCE_AUTO,
+	// x86 time-stamp counter, read with rdtscp
+	CLOCK_SOURCE_TSC,
+	// RISC-V cycle counter (may be disabled for user space)
+	CLOCK_SOURCE_RDCYCLE,
+	// RISC-V constant-rate timer
+	CLOCK_SOURCE_RDTIME,
+	// clock_gettime(CLOCK_MONOTONIC_RAW), available everywhere
+	CLOCK_SOURCE_MONOTONIC
+} ClockSource;
+
+// The histogram is log-bucketed in the style of HdrHistogram: every power of
+// two is split into 2^HISTOGRAM_SUB_BITS linear sub-buckets, so the relative
+// error of any recorded value is below 1 / 2^HISTOGRAM_SUB_BITS (about 3%).
+// Values below 2^(HISTOGRAM_SUB_BITS + 1) nanoseconds are recorded exactly.
+#define HISTOGRAM_SUB_BITS 5
+#define HISTOGRAM_SUB_COUNT (1 << HISTOGRAM_SUB_BITS)
+#define HISTOGRAM_BUCKETS ((64 - HISTOGRAM_SUB_BITS + 1) * HISTOGRAM_SUB_COUNT)
+
+typedef struct Histogram {
+	// Number of recorded samples
+	bench_t count;
+
+	// Sample count per bucket
+	bench_t buckets[HISTOGRAM_BUCKETS];
+
+} Histogram;
+
+// Number of latest samples used for the steady-state check
+#define WARMUP_WINDOW 64
+
+typedef enum BenchmarkPhase {
+	// Samples are discarded until the warmup criteria are met
+	PHASE_WARMUP,
+	// Samples are recorded until the message count is reached
+	PHASE_MEASURE,
+	// Remaining (unused warmup) messages are not recorded
+	PHASE_DONE
+} BenchmarkPhase;
+
 typedef struct Benchmarks {
 	// Start of the total benchmarking
 	bench_t total_start;
@@ -21,17 +73,148 @@ typedef struct Benchmarks {
 	// Sum (for averaging)
 	bench_t sum;
 
-	// Squared sum (for standard deviation)
-	bench_t squared_sum;
+	// Latency distribution of all single benchmarks
+	Histogram histogram;
+
+	// The current BenchmarkPhase
+	int phase;
+
+	// End of the total benchmarking (once the count is reached)
+	bench_t total_end;
+
+	// CPU time of the process at the start and end of the benchmarking
+	bench_t cpu_start;
+	bench_t cpu_end;
+
+	// Warmup messages discarded so far
+	int warmup_messages;
+
+	// Start of the warmup
+	bench_t warmup_start;
+
+	// Rolling window of the latest warmup samples
+	bench_t window[WARMUP_WINDOW];
+	double window_sum;
+	double window_squared_sum;
+
+	// Counters of the measuring thread and its peer over the measurement
+	PerfGroup perf[PERF_SIDES];
+
+	// The thread on the other end of the transport (0 = unknown)
+	pid_t peer;
+
+	// CPU usage of the measuring thread and its peer, at the start of the
+	// measurement until it ends and over the measurement after that
+	CpuUsage usage[PERF_SIDES];
 
 } Benchmarks;
 
+/******************** INTERFACE ********************/
+
 bench_t now();
 
+/**
+ * Selects and calibrates the time source used by now().
+ *
+ * Also measures the overhead of a pair of now() calls, which benchmark()
+ * subtracts from every sample. Terminates if the source is not available on
+ * this architecture.
+ *
+ * \param source The clock to use.
+ */
+void setup_clock(ClockSource source);
+
+ClockSource parse_clock(const char *name);
+
+const char *clock_name();
+
+// Counter ticks per nanosecond, zero for CLOCK_MONOTONIC_RAW
+double clock_frequency();
+
+bench_t clock_overhead();
+
+/**
+ * Configures the warmup of all subsequent benchmarks.
+ *
+ * Until the warmup criteria of the arguments are met, benchmark() discards
+ * its samples and the total duration does not start. Once the message count
+ * is reached, further samples are discarded, so the measuring side can loop
+ * over total_messages() like its peer does.
+ *
+ * \param args The parsed arguments.
+ */
+void setup_warmup(struct Arguments *args);
+
+/**
+ * Configures the performance counters of all subsequent benchmarks.
+ *
+ * With --perf, setup_benchmarks() opens counters for the calling thread,
+ * which are read when the measurement starts and ends, next to the CPU time.
+ *
+ * \param args The parsed arguments.
+ */
+void setup_perf(struct Arguments *args);
+
 void setup_benchmarks(Benchmarks *bench);
 
+/**
+ * Also accounts for the thread on the other end of the transport.
+ *
+ * Its CPU usage, and with --perf its counters, are then reported next to
+ * those of the measuring thread.
+ *
+ * \param bench The benchmark, after setup_benchmarks().
+ * \param peer The thread (or single-threaded process) of the peer.
+ */
+void benchmarks_count_peer(Benchmarks *bench, pid_t peer);
+
+// Measures the CPU usage of the calling thread from now on, without
+// samples or warmup, e.g. of a thread serving several benchmarks at once
+void benchmarks_start(Benchmarks *bench);
+
+// Ends a measurement on the measuring thread, unless it is done already
+void benchmarks_stop(Benchmarks *bench);
+
 void benchmark(Benchmarks *bench);
 
+// Records a duration between two now() calls, like benchmark() does
+void benchmark_sample(Benchmarks *bench, bench_t time);
+
 void evaluate(Benchmarks *bench, struct Arguments *args);
 
+// Computes the results evaluate() prints, without printing them
+void summarize(Benchmarks *bench,
+							 struct Arguments *args,
+							 struct Results *results);
+
+/**
+ * Adds the samples and CPU time of one benchmark to another.
+ *
+ * The total duration of into is left alone, since the runs being merged
+ * may have been timed by different processes.
+ *
+ * \param into The benchmark to add to, with a minimum of UINT64_MAX if empty.
+ * \param from The benchmark to add.
+ */
+void benchmarks_merge(Benchmarks *into, const Benchmarks *from);
+
+// Adds only the samples, for benchmarks whose threads overlap
+void benchmarks_merge_samples(Benchmarks *into, const Benchmarks *from);
+
+// Adds only the CPU time, usage and counters
+void benchmarks_merge_usage(Benchmarks *into, const Benchmarks *from);
+
+void histogram_record(Histogram *histogram, bench_t value);
+
+/**
+ * Returns the value below which the given percentage of all samples fall.
+ *
+ * The result is the upper bound of the bucket holding that sample, i.e. it is
+ * never smaller than the exact percentile.
+ *
+ * \param histogram The histogram to query.
+ * \param percentile A percentage in [0, 100].
+ */
+bench_t histogram_percentile(const Histogram *histogram, double percentile);
+
 #endif /* IPC_BENCH_BENCHMARKS_H */
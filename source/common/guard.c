@@ -0,0 +1,70 @@
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "common/arguments.h"
+#include "common/guard.h"
+
+static void futex_wait(atomic_int* address, int expected) {
+	// Not FUTEX_PRIVATE_FLAG: the word is shared between processes.
+	// Returns right away if the word no longer holds the expected value.
+	syscall(SYS_futex, address, FUTEX_WAIT, expected, NULL, NULL, 0);
+}
+
+static void futex_wake(atomic_int* address) {
+	syscall(SYS_futex, address, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+void guard_sleep(Guard* guard, int token) {
+	int current;
+
+	while ((current = atomic_load(&guard->token)) != token) {
+		// Registering before checking the token again means that
+		// the peer either sees us sleeping or we see its token
+		atomic_fetch_add(&guard->sleepers, 1);
+		futex_wait(&guard->token, current);
+		atomic_fetch_sub(&guard->sleepers, 1);
+	}
+}
+
+void guard_sleep_while(Guard* guard, int token) {
+	while (atomic_load(&guard->token) == token) {
+		atomic_fetch_add(&guard->sleepers, 1);
+		futex_wait(&guard->token, token);
+		atomic_fetch_sub(&guard->sleepers, 1);
+	}
+}
+
+void guard_wait(Guard* guard, int token, const Arguments* args) {
+	int spins;
+
+	switch (args->wait) {
+		case WAIT_FUTEX: guard_sleep(guard, token); return;
+		case WAIT_HYBRID:
+			for (spins = args->spin_count; spins > 0; --spins) {
+				if (atomic_load(&guard->token) == token) return;
+			}
+			guard_sleep(guard, token);
+			return;
+		default:
+			while (atomic_load(&guard->token) != token)
+				;
+	}
+}
+
+void guard_notify(Guard* guard, int token) {
+	atomic_store(&guard->token, token);
+
+	if (atomic_load(&guard->sleepers) > 0) {
+		futex_wake(&guard->token);
+	}
+}
+
+void guard_ring(Guard* guard) {
+	atomic_fetch_add(&guard->token, 1);
+
+	if (atomic_load(&guard->sleepers) > 0) {
+		futex_wake(&guard->token);
+	}
+}
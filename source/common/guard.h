@@ -0,0 +1,68 @@
+#ifndef IPC_BENCH_GUARD_H
+#define IPC_BENCH_GUARD_H
+
+#include <stdalign.h>
+#include <stdatomic.h>
+
+#include "common/utility.h"
+
+struct Arguments;
+
+/******************** DEFINITIONS ********************/
+
+// How a process waits for its turn
+typedef enum WaitMode {
+	// Poll the guard until it changes (burns a core)
+	WAIT_SPIN,
+	// Sleep in FUTEX_WAIT until the peer wakes us
+	WAIT_FUTEX,
+	// Poll for a bounded number of times, then sleep
+	WAIT_HYBRID
+} WaitMode;
+
+// Default number of polls of the hybrid wait before it sleeps
+#define DEFAULT_SPIN_COUNT 1000
+
+// A word in shared memory holding the token of whoever may go next. It
+// fills a cache line, so that the message following it does not share one.
+typedef struct Guard {
+	alignas(CACHE_LINE) atomic_int token;
+	// Number of processes sleeping on the token, so that notifying
+	// a spinning peer does not cost a system call
+	atomic_int sleepers;
+} Guard;
+
+/******************** INTERFACE ********************/
+
+/**
+ * Waits until the guard holds the given token, as configured by --wait.
+ *
+ * \param guard The guard in shared memory.
+ * \param token The token to wait for.
+ * \param args The arguments with the wait mode.
+ */
+void guard_wait(Guard* guard, int token, const struct Arguments* args);
+
+// Sleeps in FUTEX_WAIT until the guard holds the given token, ignoring --wait
+void guard_sleep(Guard* guard, int token);
+
+// Sleeps in FUTEX_WAIT while the guard still holds the given token
+void guard_sleep_while(Guard* guard, int token);
+
+/**
+ * Adds one to the token and wakes up sleepers, for a guard used as a doorbell
+ * that is rung by several processes.
+ *
+ * \param guard The guard in shared memory.
+ */
+void guard_ring(Guard* guard);
+
+/**
+ * Stores the token in the guard and wakes up the peer if it sleeps.
+ *
+ * \param guard The guard in shared memory.
+ * \param token The token to hand over.
+ */
+void guard_notify(Guard* guard, int token);
+
+#endif /* IPC_BENCH_GUARD_H */
@@ -0,0 +1,160 @@
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "common/perf.h"
+#include "common/utility.h"
+
+// Which privilege levels an event counts
+typedef enum PerfScope {
+	PERF_SCOPE_USER,
+	PERF_SCOPE_KERNEL,
+	// Both, or user space only if the kernel does not let us count it
+	PERF_SCOPE_ANY
+} PerfScope;
+
+typedef struct PerfEvent {
+	const char* name;
+	unsigned int type;
+	unsigned long long config;
+	PerfScope scope;
+} PerfEvent;
+
+// clang-format off
+static const PerfEvent events[PERF_COUNTERS] = {
+	{"cycles_user", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, PERF_SCOPE_USER},
+	{"cycles_kernel", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, PERF_SCOPE_KERNEL},
+	{"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, PERF_SCOPE_ANY},
+	{"llc_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, PERF_SCOPE_ANY},
+	{"context_switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, PERF_SCOPE_ANY},
+	{"page_faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, PERF_SCOPE_ANY},
+};
+// clang-format on
+
+static int open_event(const PerfEvent* event,
+											pid_t thread,
+											int leader,
+											bool user_only) {
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof attr);
+	attr.size = sizeof attr;
+	attr.type = event->type;
+	attr.config = event->config;
+	attr.exclude_user = (event->scope == PERF_SCOPE_KERNEL);
+	attr.exclude_kernel = (event->scope == PERF_SCOPE_USER || user_only);
+	attr.exclude_hv = 1;
+	// Time enabled and running tell us if the kernel multiplexed the group
+	// clang-format off
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+										 PERF_FORMAT_TOTAL_TIME_RUNNING;
+	// clang-format on
+
+	// There is no glibc wrapper for perf_event_open()
+	// clang-format off
+	return syscall(
+		SYS_perf_event_open, &attr, thread, -1, leader, PERF_FLAG_FD_CLOEXEC
+	);
+	// clang-format on
+}
+
+void perf_open(PerfGroup* group, pid_t thread) {
+	static bool warned = false;
+	int leader = -1;
+	int counter;
+	int descriptor;
+
+	perf_clear(group);
+
+	for (counter = 0; counter < PERF_COUNTERS; ++counter) {
+		descriptor = open_event(&events[counter], thread, leader, false);
+
+		// perf_event_paranoid >= 2 keeps the kernel out of reach
+		if (descriptor == -1 && (errno == EACCES || errno == EPERM) &&
+				events[counter].scope == PERF_SCOPE_ANY) {
+			descriptor = open_event(&events[counter], thread, leader, true);
+		}
+
+		group->descriptors[counter] = descriptor;
+		if (leader == -1) {
+			leader = descriptor;
+		}
+	}
+
+	if (leader == -1 && !warned) {
+		warn("No performance counters available, see perf_event_paranoid");
+		warned = true;
+	}
+}
+
+void perf_clear(PerfGroup* group) {
+	int counter;
+
+	for (counter = 0; counter < PERF_COUNTERS; ++counter) {
+		group->descriptors[counter] = -1;
+		group->counts[counter] = -1;
+	}
+}
+
+static bool read_counter(int descriptor, unsigned long long values[3]) {
+	const ssize_t size = 3 * sizeof values[0];
+
+	return read(descriptor, values, size) == size;
+}
+
+void perf_start(PerfGroup* group) {
+	int counter;
+
+	for (counter = 0; counter < PERF_COUNTERS; ++counter) {
+		if (group->descriptors[counter] == -1) continue;
+
+		if (!read_counter(group->descriptors[counter], group->start[counter])) {
+			throw("Error reading performance counter");
+		}
+	}
+}
+
+void perf_stop(PerfGroup* group) {
+	unsigned long long end[3];
+	double value, enabled, running;
+	int counter;
+
+	for (counter = 0; counter < PERF_COUNTERS; ++counter) {
+		if (group->descriptors[counter] == -1) continue;
+
+		if (!read_counter(group->descriptors[counter], end)) {
+			throw("Error reading performance counter");
+		}
+		close(group->descriptors[counter]);
+		group->descriptors[counter] = -1;
+
+		value = end[0] - group->start[counter][0];
+		enabled = end[1] - group->start[counter][1];
+		running = end[2] - group->start[counter][2];
+
+		// A group that never got on the PMU counted nothing
+		if (running > 0) {
+			group->counts[counter] = value * (enabled / running);
+		}
+	}
+}
+
+void perf_merge(PerfGroup* into, const PerfGroup* from) {
+	int counter;
+
+	for (counter = 0; counter < PERF_COUNTERS; ++counter) {
+		if (from->counts[counter] < 0) continue;
+
+		if (into->counts[counter] < 0) {
+			into->counts[counter] = 0;
+		}
+		into->counts[counter] += from->counts[counter];
+	}
+}
+
+const char* perf_counter_name(PerfCounter counter) {
+	return events[counter].name;
+}
@@ -0,0 +1,74 @@
+#ifndef IPC_BENCH_PERF_H
+#define IPC_BENCH_PERF_H
+
+#include <sys/types.h>
+
+/******************** DEFINITIONS ********************/
+
+// The events counted with --perf
+typedef enum PerfCounter {
+	// CPU cycles spent in user space and in the kernel
+	PERF_CYCLES_USER,
+	PERF_CYCLES_KERNEL,
+	// Instructions retired (in user space only if the kernel is off limits)
+	PERF_INSTRUCTIONS,
+	// Misses of the last-level cache
+	PERF_LLC_MISSES,
+	PERF_CONTEXT_SWITCHES,
+	PERF_PAGE_FAULTS
+} PerfCounter;
+
+#define PERF_COUNTERS (PERF_PAGE_FAULTS + 1)
+
+// Whose counters a group holds
+typedef enum PerfSide {
+	// The thread that measures
+	PERF_SELF,
+	// The thread on the other end of the transport, if known
+	PERF_PEER
+} PerfSide;
+
+#define PERF_SIDES (PERF_PEER + 1)
+
+// The counters of one thread, read at the start and end of the measurement
+typedef struct PerfGroup {
+	// Descriptors of the counters (-1 = not available)
+	int descriptors[PERF_COUNTERS];
+
+	// Value, time enabled and time running at the start
+	unsigned long long start[PERF_COUNTERS][3];
+
+	// Counts between start and end, scaled if the kernel multiplexed
+	// the counters (-1 = not counted)
+	double counts[PERF_COUNTERS];
+
+} PerfGroup;
+
+/******************** INTERFACE ********************/
+
+/**
+ * Opens the counters of a thread as one group, so that they are scheduled
+ * together.
+ *
+ * Events the hardware, the kernel or perf_event_paranoid do not allow are
+ * left out, with a warning if no event could be opened at all.
+ *
+ * \param group The group to open.
+ * \param thread The thread to count, 0 for the calling one.
+ */
+void perf_open(PerfGroup* group, pid_t thread);
+
+// Marks all counters of the group as not counted
+void perf_clear(PerfGroup* group);
+
+void perf_start(PerfGroup* group);
+
+// Computes the counts since perf_start() and closes the counters
+void perf_stop(PerfGroup* group);
+
+// Adds the counts of one group to another, like benchmarks_merge()
+void perf_merge(PerfGroup* into, const PerfGroup* from);
+
+const char* perf_counter_name(PerfCounter counter);
+
+#endif /* IPC_BENCH_PERF_H */
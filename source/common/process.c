@@ -1,4 +1,5 @@
 #include <assert.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -7,38 +8,11 @@
 #include <sys/types.h>
 #include <sys/wait.h>
 
+#include "common/arguments.h"
+#include "common/process.h"
 #include "common/utility.h"
 
-#define BUILD_PATH "/build/source\0"
-
-char *find_build_path() {
-	char *path = (char *)malloc(strlen(__FILE__) + strlen(BUILD_PATH));
-	char *right;
-	char *left;
-
-	strcpy(path, __FILE__);
-	right = path + strlen(__FILE__);
-	left = right - strlen("ipc-bench");
-
-	// Make the string-comparison expected O(N)
-	// by only doing a string-comparison when
-	// the first and last character match
-	for (--right; left >= path; --left, --right) {
-		if (*left == 'i' && *right == 'h') {
-			if (strncmp("ipc-bench", left, 9) == 0) {
-				break;
-			}
-		}
-	}
-
-	// ++ because right is on the 'h'
-	strcpy(++right, BUILD_PATH);
-
-	return path;
-}
-
-
-pid_t start_process(char *argv[]) {
+pid_t start_process(char *argv[], int cpu) {
 	// Will need to set the group id
 	const pid_t parent_pid = getpid();
 	const pid_t pid = fork();
@@ -49,6 +23,8 @@ pid_t start_process(char *argv[]) {
 		if (setpgid(pid, parent_pid) == -1) {
 			throw("Could not set group id for child process");
 		}
+		// The affinity mask is inherited across exec
+		pin_thread(cpu);
 		// Replace the current process with the command
 		// we want to execute (child or server)
 		// First argument is the command to call,
@@ -65,7 +41,6 @@ pid_t start_process(char *argv[]) {
 
 void copy_arguments(char *arguments[], int argc, char *argv[]) {
 	int i;
-	assert(argc < 8);
 	for (i = 1; i < argc; ++i) {
 		arguments[i] = argv[i];
 	}
@@ -73,44 +48,50 @@ void copy_arguments(char *arguments[], int argc, char *argv[]) {
 	arguments[argc] = NULL;
 }
 
-pid_t start_child(char *name, int argc, char *argv[]) {
-	char *arguments[8] = {name};
+pid_t start_child(char *name, int argc, char *argv[], int cpu) {
+	char *arguments[argc + 1];
+	arguments[0] = name;
 	copy_arguments(arguments, argc, argv);
-	return start_process(arguments);
+	return start_process(arguments, cpu);
 }
 
 void start_children(char *prefix, int argc, char *argv[]) {
-	char server_name[100];
-	char client_name[100];
+	char directory[PATH_MAX];
+	char server_name[PATH_MAX + 100];
+	char client_name[PATH_MAX + 100];
+	struct Arguments args;
 
-	char *build_path = find_build_path();
+	// The server and client are built next to the parent
+	executable_directory(directory, sizeof directory);
 
 	// clang-format off
 	sprintf(
 		server_name,
-		"/tests/ipc-bench/%s/%s-%s",
-		prefix,
+		"%s/%s-%s",
+		directory,
 		prefix,
 		"server"
 	);
 
 	sprintf(
 		client_name,
-		"/tests/ipc-bench/%s/%s-%s",
-		prefix,
+		"%s/%s-%s",
+		directory,
 		prefix,
 		"client"
 	);
 	// clang-format on
 
-	printf("Starting Child: %s\n",server_name);
-	printf("Starting Child: %s\n",client_name);
-	
-	pid_t c1_id = start_child(server_name, argc, argv);
-	pid_t c2_id = start_child(client_name, argc, argv);
+	// For the CPUs to pin the children to
+	parse_arguments(&args, argc, argv);
+
+	// Keep stdout clean for machine-readable results
+	fprintf(stderr, "Starting Child: %s\n", server_name);
+	fprintf(stderr, "Starting Child: %s\n", client_name);
+
+	pid_t c1_id = start_child(server_name, argc, argv, args.server_cpu);
+	pid_t c2_id = start_child(client_name, argc, argv, args.client_cpu);
 
 	waitpid(c1_id, NULL, WUNTRACED);
 	waitpid(c2_id, NULL, WUNTRACED);
-
-	free(build_path);
 }
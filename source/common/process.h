@@ -1,14 +1,24 @@
 #ifndef IPC_BENCH_PROCESS_H
 #define IPC_BENCH_PROCESS_H
 
-char *find_build_path();
+#include <sys/types.h>
 
-void start_process(char *argv[]);
+pid_t start_process(char *argv[], int cpu);
 
 void copy_arguments(char *arguments[], int argc, char *argv[]);
 
-void start_child(char *name, int argc, char *argv[]);
+pid_t start_child(char *name, int argc, char *argv[], int cpu);
 
+/**
+ * Starts the server and client of a transport and waits for both.
+ *
+ * The children are pinned to the CPUs given by --server-cpu and --client-cpu
+ * before they are exec()'d.
+ *
+ * \param prefix The name of the transport.
+ * \param argc The number of command line arguments.
+ * \param argv The command line arguments, passed on to the children.
+ */
 void start_children(char *prefix, int argc, char *argv[]);
 
 #endif /* IPC_BENCH_PROCESS_H */
@@ -0,0 +1,549 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/utsname.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "common/arguments.h"
+#include "common/results.h"
+#include "common/utility.h"
+
+const double result_percentiles[RESULT_PERCENTILES] = {50, 90, 99, 99.9, 99.99};
+
+static const char* percentile_keys[RESULT_PERCENTILES] = {
+		"p50", "p90", "p99", "p99.9", "p99.99"};
+
+static const char* percentile_labels[RESULT_PERCENTILES] = {
+		"50th percentile:",
+		"90th percentile:",
+		"99th percentile:",
+		"99.9th percentile:",
+		"99.99th percentile:"};
+
+static const char* perf_sides[PERF_SIDES] = {"self", "peer"};
+
+// A field of CpuUsage, with its key in JSON and CSV and how text shows it
+typedef struct UsageField {
+	const char* key;
+	const char* label;
+	size_t offset;
+	double scale;
+	const char* unit;
+} UsageField;
+
+// clang-format off
+static const UsageField usage_fields[] = {
+	{"cpu_ns", "cpu", offsetof(CpuUsage, cpu), 1000, "us"},
+	{"user_ns", "user", offsetof(CpuUsage, user), 1000, "us"},
+	{"system_ns", "system", offsetof(CpuUsage, system), 1000, "us"},
+	{"wait_ns", "runqueue wait", offsetof(CpuUsage, waiting), 1000, "us"},
+	{"voluntary_switches", "voluntary", offsetof(CpuUsage, voluntary), 1, "switches"},
+	{"involuntary_switches", "involuntary", offsetof(CpuUsage, involuntary), 1, "switches"},
+};
+// clang-format on
+
+#define USAGE_FIELDS (sizeof usage_fields / sizeof usage_fields[0])
+
+typedef struct Host {
+	struct utsname name;
+	char cpu[128];
+	long cpus;
+} Host;
+
+OutputFormat parse_format(const char* name) {
+	if (strcmp(name, "text") == 0) return FORMAT_TEXT;
+	if (strcmp(name, "json") == 0) return FORMAT_JSON;
+	if (strcmp(name, "csv") == 0) return FORMAT_CSV;
+	if (strcmp(name, "csv-noheader") == 0) return FORMAT_CSV_NOHEADER;
+
+	terminate("Unknown format, use one of text, json, csv, csv-noheader\n");
+}
+
+static void read_cpu_model(char* model, size_t size) {
+	char line[256];
+	char* value;
+	FILE* cpuinfo;
+
+	strncpy(model, "unknown", size);
+
+	if ((cpuinfo = fopen("/proc/cpuinfo", "r")) == NULL) return;
+
+	while (fgets(line, sizeof line, cpuinfo) != NULL) {
+		// x86 reports a "model name", RISC-V only an "isa" (and maybe "uarch")
+		if (strncmp(line, "model name", 10) != 0 && strncmp(line, "uarch", 5) != 0 &&
+				strncmp(line, "isa", 3) != 0) {
+			continue;
+		}
+		if ((value = strchr(line, ':')) == NULL) continue;
+
+		// Skip ": " and drop the newline
+		for (++value; *value == ' ' || *value == '\t'; ++value)
+			;
+		value[strcspn(value, "\n")] = '\0';
+		strncpy(model, value, size - 1);
+		model[size - 1] = '\0';
+
+		if (strncmp(line, "isa", 3) != 0) break;
+	}
+
+	fclose(cpuinfo);
+}
+
+static void get_host(Host* host) {
+	if (uname(&host->name) == -1) {
+		throw("Error retrieving host information");
+	}
+	read_cpu_model(host->cpu, sizeof host->cpu);
+	host->cpus = sysconf(_SC_NPROCESSORS_ONLN);
+}
+
+static void print_json_string(const char* string) {
+	putchar('"');
+	for (; *string != '\0'; ++string) {
+		if (*string == '"' || *string == '\\') {
+			putchar('\\');
+		}
+		if ((unsigned char)*string >= 0x20) {
+			putchar(*string);
+		}
+	}
+	putchar('"');
+}
+
+static void print_csv_string(const char* string) {
+	putchar('"');
+	for (; *string != '\0'; ++string) {
+		// Quotes are escaped by doubling them
+		if (*string == '"') putchar('"');
+		putchar(*string);
+	}
+	putchar('"');
+}
+
+static double usage_value(const CpuUsage* usage, const UsageField* field) {
+	return *(const double*)((const char*)usage + field->offset);
+}
+
+// CPU time per byte of payload, to compare sizes (e.g. of zero-copy sends)
+static double cpu_per_byte(const Results* results) {
+	return (results->size > 0) ? results->cpu_time / results->size : 0;
+}
+
+static void print_text_usage(const Results* results) {
+	const int sides = results->peer_usage ? PERF_SIDES : 1;
+	const UsageField* field;
+	double value;
+	int side;
+
+	if (sides > 1) {
+		printf("CPU usage:          per message, measuring thread / peer\n");
+	} else {
+		printf("CPU usage:          per message, measuring thread\n");
+	}
+
+	for (field = usage_fields; field < usage_fields + USAGE_FIELDS; ++field) {
+		printf("  %-18s", field->label);
+		for (side = 0; side < sides; ++side) {
+			if (side > 0) printf(" / ");
+			if ((value = usage_value(&results->usage[side], field)) >= 0) {
+				printf("%.3f", value / field->scale);
+			} else {
+				printf("n/a");
+			}
+		}
+		printf("\t%s\n", field->unit);
+	}
+}
+
+static void print_text_counters(const Results* results) {
+	int counter;
+	int side;
+
+	printf("Counters:           per message, measuring thread / peer\n");
+	for (counter = 0; counter < PERF_COUNTERS; ++counter) {
+		printf("  %-18s", perf_counter_name(counter));
+		for (side = 0; side < PERF_SIDES; ++side) {
+			if (side > 0) printf(" / ");
+			if (results->counters[side][counter] >= 0) {
+				printf("%.1f", results->counters[side][counter]);
+			} else {
+				printf("n/a");
+			}
+		}
+		printf("\n");
+	}
+}
+
+static void print_text(const Results* results) {
+	int index;
+
+	printf("\n============ RESULTS ================\n");
+	printf("Transport:          %s\n", results->transport);
+	printf("Message size:       %d\n", results->size);
+	printf("Message count:      %d\n", results->count);
+	if (results->warmup > 0) {
+		printf("Warmup messages:    %d\n", results->warmup);
+	}
+	if (results->window > 0) {
+		printf("Mode:               %s (%d in flight)\n",
+					 results->mode,
+					 results->window);
+	} else if (strcmp(results->mode, "pingpong") != 0) {
+		printf("Mode:               %s\n", results->mode);
+	}
+	if (results->client >= 0) {
+		printf("Clients:            %d (client %d)\n",
+					 results->clients,
+					 results->client);
+	} else if (results->clients > 1) {
+		printf("Clients:            %d (all)\n", results->clients);
+	}
+	if (results->series != NULL) {
+		printf("Series:             %s\n", results->series);
+	}
+	printf("Total duration:     %.3f\tms\n", results->total_time / 1e6);
+	if (results->clock_frequency > 0) {
+		printf("Clock source:       %s (%.1f MHz)\n",
+					 results->clock,
+					 results->clock_frequency * 1e3);
+	} else {
+		printf("Clock source:       %s\n", results->clock);
+	}
+	printf("Clock overhead:     %llu\tns\n", results->clock_overhead);
+	if (results->server_cpu >= 0 || results->client_cpu >= 0) {
+		printf("CPU placement:      server %d, client %d (%s)\n",
+					 results->server_cpu,
+					 results->client_cpu,
+					 results->relation);
+	}
+
+	// Transports that only time the whole run record no single samples
+	if (results->samples > 0) {
+		printf("Average duration:   %.3f\tus\n", results->average / 1000.0);
+		printf("Minimum duration:   %.3f\tus\n", results->minimum / 1000.0);
+		for (index = 0; index < RESULT_PERCENTILES; ++index) {
+			printf("%-20s%.3f\tus\n",
+						 percentile_labels[index],
+						 results->percentiles[index] / 1000.0);
+		}
+		printf("Maximum duration:   %.3f\tus\n", results->maximum / 1000.0);
+	}
+
+	if (results->offered_rate > 0) {
+		printf("Offered rate:       %d\tmsg/s\n", (int)results->offered_rate);
+	}
+	printf("Message rate:       %d\tmsg/s\n", (int)results->message_rate);
+	printf("Bandwidth:          %.3f\tGB/s\n", results->byte_rate / 1e9);
+	// The CPU time per message is the cpu line of the usage below
+	printf("CPU per byte:       %.3f\tns/B\n", cpu_per_byte(results));
+	if (results->per_notification > 0) {
+		printf("Per notification:   %.2f\tmsg\n", results->per_notification);
+	}
+	if (results->per_receive > 0) {
+		printf("Per receive call:   %.2f\tmsg\n", results->per_receive);
+	}
+	if (results->syscalls >= 0) {
+		printf("System calls:       %.2f\tper msg\n", results->syscalls);
+	}
+	if (results->copied >= 0) {
+		printf("Copied sends:       %.1f\t%%\n", results->copied * 100);
+	}
+	print_text_usage(results);
+	if (results->perf) {
+		print_text_counters(results);
+	}
+	printf("=====================================\n");
+}
+
+static void print_json_usage(const Results* results) {
+	const UsageField* field;
+	double value;
+	int side;
+
+	printf(",\"usage\":");
+	for (side = 0; side < PERF_SIDES; ++side) {
+		printf("%s\"%s\":", side == 0 ? "{" : ",", perf_sides[side]);
+		if (side > 0 && !results->peer_usage) {
+			printf("null");
+			continue;
+		}
+
+		for (field = usage_fields; field < usage_fields + USAGE_FIELDS; ++field) {
+			printf("%s\"%s\":", field == usage_fields ? "{" : ",", field->key);
+			if ((value = usage_value(&results->usage[side], field)) >= 0) {
+				printf("%.1f", value);
+			} else {
+				printf("null");
+			}
+		}
+		printf("}");
+	}
+	printf("}");
+}
+
+static void print_json_counters(const Results* results) {
+	int counter;
+	int side;
+
+	printf(",\"perf\":");
+	if (!results->perf) {
+		printf("null");
+		return;
+	}
+
+	for (side = 0; side < PERF_SIDES; ++side) {
+		printf("%s\"%s\":{", side == 0 ? "{" : ",", perf_sides[side]);
+		for (counter = 0; counter < PERF_COUNTERS; ++counter) {
+			if (counter > 0) printf(",");
+			printf("\"%s\":", perf_counter_name(counter));
+			if (results->counters[side][counter] >= 0) {
+				printf("%.1f", results->counters[side][counter]);
+			} else {
+				printf("null");
+			}
+		}
+		printf("}");
+	}
+	printf("}");
+}
+
+static void print_json(const Results* results, const Host* host) {
+	int index;
+
+	printf("{\"transport\":");
+	print_json_string(results->transport);
+	printf(",\"timestamp\":%ld", (long)time(NULL));
+	printf(",\"size\":%d,\"count\":%d", results->size, results->count);
+	printf(",\"warmup\":%d", results->warmup);
+	printf(",\"mode\":");
+	print_json_string(results->mode);
+	printf(",\"window\":%d", results->window);
+	printf(",\"clients\":%d,\"client\":%d", results->clients, results->client);
+	printf(",\"series\":");
+	if (results->series != NULL) {
+		print_json_string(results->series);
+	} else {
+		printf("null");
+	}
+	printf(",\"total_ns\":%llu", results->total_time);
+
+	printf(",\"latency_ns\":");
+	if (results->samples > 0) {
+		printf("{\"samples\":%llu,\"average\":%.1f,\"min\":%llu",
+					 results->samples,
+					 results->average,
+					 results->minimum);
+		for (index = 0; index < RESULT_PERCENTILES; ++index) {
+			printf(",\"%s\":%llu", percentile_keys[index], results->percentiles[index]);
+		}
+		printf(",\"max\":%llu}", results->maximum);
+	} else {
+		printf("null");
+	}
+
+	printf(",\"offered_per_second\":%.1f", results->offered_rate);
+	printf(",\"messages_per_second\":%.1f", results->message_rate);
+	printf(",\"bytes_per_second\":%.1f", results->byte_rate);
+	printf(",\"cpu_ns_per_message\":%.1f", results->cpu_time);
+	printf(",\"cpu_ns_per_byte\":%.3f", cpu_per_byte(results));
+	printf(",\"messages_per_notification\":");
+	if (results->per_notification > 0) {
+		printf("%.2f", results->per_notification);
+	} else {
+		printf("null");
+	}
+	printf(",\"messages_per_receive\":");
+	if (results->per_receive > 0) {
+		printf("%.2f", results->per_receive);
+	} else {
+		printf("null");
+	}
+	printf(",\"syscalls_per_message\":");
+	if (results->syscalls >= 0) {
+		printf("%.2f", results->syscalls);
+	} else {
+		printf("null");
+	}
+	printf(",\"zerocopy_copied\":");
+	if (results->copied >= 0) {
+		printf("%.3f", results->copied);
+	} else {
+		printf("null");
+	}
+	print_json_usage(results);
+	print_json_counters(results);
+
+	printf(",\"clock\":{\"source\":");
+	print_json_string(results->clock);
+	printf(",\"mhz\":%.1f,\"overhead_ns\":%llu}",
+				 results->clock_frequency * 1e3,
+				 results->clock_overhead);
+
+	printf(",\"placement\":{\"server_cpu\":%d", results->server_cpu);
+	printf(",\"client_cpu\":%d,\"relation\":", results->client_cpu);
+	print_json_string(results->relation);
+	printf("}");
+
+	printf(",\"host\":{\"name\":");
+	print_json_string(host->name.nodename);
+	printf(",\"kernel\":");
+	print_json_string(host->name.release);
+	printf(",\"machine\":");
+	print_json_string(host->name.machine);
+	printf(",\"cpu\":");
+	print_json_string(host->cpu);
+	printf(",\"cpus\":%ld}", host->cpus);
+
+	printf("}\n");
+}
+
+static void print_csv_header() {
+	int index;
+	int side;
+
+	printf("transport,timestamp,size,count,warmup,mode,window");
+	printf(",clients,client,series,total_ns");
+	printf(",samples,average_ns,min_ns");
+	for (index = 0; index < RESULT_PERCENTILES; ++index) {
+		printf(",%s_ns", percentile_keys[index]);
+	}
+	printf(",max_ns,offered_per_second,messages_per_second,bytes_per_second");
+	printf(",cpu_ns_per_message,cpu_ns_per_byte,messages_per_notification");
+	printf(",messages_per_receive,syscalls_per_message,zerocopy_copied");
+	for (side = 0; side < PERF_SIDES; ++side) {
+		for (index = 0; index < (int)USAGE_FIELDS; ++index) {
+			printf(",%s_%s", perf_sides[side], usage_fields[index].key);
+		}
+	}
+	for (side = 0; side < PERF_SIDES; ++side) {
+		for (index = 0; index < PERF_COUNTERS; ++index) {
+			printf(",%s_%s", perf_sides[side], perf_counter_name(index));
+		}
+	}
+	printf(",clock,clock_mhz,clock_overhead_ns");
+	printf(",server_cpu,client_cpu,relation");
+	printf(",host,kernel,machine,cpu,cpus\n");
+}
+
+static void print_csv(const Results* results, const Host* host, bool header) {
+	// Once for all runs of a process
+	static bool header_printed = false;
+	double value;
+	int index;
+	int side;
+
+	if (header && !header_printed) {
+		print_csv_header();
+		header_printed = true;
+	}
+
+	// Values (latency columns stay empty without samples)
+	print_csv_string(results->transport);
+	printf(",%ld,%d,%d,%d,%s,%d,%d,%d,%s,%llu",
+				 (long)time(NULL),
+				 results->size,
+				 results->count,
+				 results->warmup,
+				 results->mode,
+				 results->window,
+				 results->clients,
+				 results->client,
+				 results->series != NULL ? results->series : "",
+				 results->total_time);
+	if (results->samples > 0) {
+		printf(",%llu,%.1f,%llu",
+					 results->samples,
+					 results->average,
+					 results->minimum);
+		for (index = 0; index < RESULT_PERCENTILES; ++index) {
+			printf(",%llu", results->percentiles[index]);
+		}
+		printf(",%llu", results->maximum);
+	} else {
+		printf(",0,,");
+		for (index = 0; index < RESULT_PERCENTILES; ++index) {
+			printf(",");
+		}
+		printf(",");
+	}
+	printf(",%.1f,%.1f,%.1f,%.1f,%.3f",
+				 results->offered_rate,
+				 results->message_rate,
+				 results->byte_rate,
+				 results->cpu_time,
+				 cpu_per_byte(results));
+	printf(",");
+	if (results->per_notification > 0) {
+		printf("%.2f", results->per_notification);
+	}
+	printf(",");
+	if (results->per_receive > 0) {
+		printf("%.2f", results->per_receive);
+	}
+	printf(",");
+	if (results->syscalls >= 0) {
+		printf("%.2f", results->syscalls);
+	}
+	printf(",");
+	if (results->copied >= 0) {
+		printf("%.3f", results->copied);
+	}
+	// Usage that is not known and counters that were not counted stay empty
+	for (side = 0; side < PERF_SIDES; ++side) {
+		for (index = 0; index < (int)USAGE_FIELDS; ++index) {
+			value = usage_value(&results->usage[side], &usage_fields[index]);
+			printf(",");
+			if ((side == PERF_SELF || results->peer_usage) && value >= 0) {
+				printf("%.1f", value);
+			}
+		}
+	}
+	for (side = 0; side < PERF_SIDES; ++side) {
+		for (index = 0; index < PERF_COUNTERS; ++index) {
+			printf(",");
+			if (results->counters[side][index] >= 0) {
+				printf("%.1f", results->counters[side][index]);
+			}
+		}
+	}
+	printf(",%s,%.1f,%llu",
+				 results->clock,
+				 results->clock_frequency * 1e3,
+				 results->clock_overhead);
+	printf(",%d,%d,%s",
+				 results->server_cpu,
+				 results->client_cpu,
+				 results->relation);
+
+	printf(",");
+	print_csv_string(host->name.nodename);
+	printf(",");
+	print_csv_string(host->name.release);
+	printf(",");
+	print_csv_string(host->name.machine);
+	printf(",");
+	print_csv_string(host->cpu);
+	printf(",%ld\n", host->cpus);
+}
+
+void print_results(const Results* results, const Arguments* args) {
+	Host host;
+
+	if (args->format == FORMAT_TEXT) {
+		print_text(results);
+		return;
+	}
+
+	get_host(&host);
+
+	if (args->format == FORMAT_JSON) {
+		print_json(results, &host);
+	} else {
+		print_csv(results, &host, args->format == FORMAT_CSV);
+	}
+
+	// Records are often appended to a file by a parent process
+	fflush(stdout);
+}
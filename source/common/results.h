@@ -0,0 +1,118 @@
+#ifndef IPC_BENCH_RESULTS_H
+#define IPC_BENCH_RESULTS_H
+
+#include "common/benchmarks.h"
+
+struct Arguments;
+
+/******************** DEFINITIONS ********************/
+
+typedef enum OutputFormat {
+	FORMAT_TEXT,
+	FORMAT_JSON,
+	FORMAT_CSV,
+	// Only the value rows, to append to the output of a --format=csv run
+	FORMAT_CSV_NOHEADER
+} OutputFormat;
+
+// The percentiles reported for every run
+#define RESULT_PERCENTILES 5
+
+typedef struct Results {
+	// The transport and its configuration
+	const char* transport;
+	int size;
+	int count;
+
+	// Wall-clock time of the timed region
+	bench_t total_time;
+
+	// Untimed messages exchanged before the timed region
+	int warmup;
+
+	// How messages were exchanged and the window of stream modes
+	const char* mode;
+	int window;
+
+	// Clients of the run and the one the result is for (-1 = all)
+	int clients;
+	int client;
+
+	// What the latencies are of, if a run reports several (or NULL)
+	const char* series;
+
+	// The load of an open-loop run in msg/s (0 = closed loop)
+	double offered_rate;
+
+	// Latency distribution (in ns), only valid if samples > 0
+	bench_t samples;
+	double average;
+	bench_t minimum;
+	bench_t percentiles[RESULT_PERCENTILES];
+	bench_t maximum;
+
+	// Throughput
+	double message_rate;
+	double byte_rate;
+
+	// CPU time (user and system, in ns) the measuring thread spent per message
+	double cpu_time;
+
+	// Messages delivered per notification of transports that batch them
+	// (0 = not reported)
+	double per_notification;
+
+	// Messages returned per receive call of transports that receive several
+	// at once, e.g. with recvmmsg() (0 = not reported)
+	double per_receive;
+
+	// System calls the measuring side made per message, for transports that
+	// count them (-1 = not counted)
+	double syscalls;
+
+	// Fraction of zero-copy sends whose data the kernel copied after all
+	// (-1 = no zero-copy sends)
+	double copied;
+
+	// CPU usage per message of the measuring thread and of its peer, the
+	// latter only if the peer was known (peer_usage)
+	CpuUsage usage[PERF_SIDES];
+	int peer_usage;
+
+	// Performance counters per message of the measuring thread and its peer
+	// (-1 = not counted), if --perf was given
+	int perf;
+	double counters[PERF_SIDES][PERF_COUNTERS];
+
+	// Placement of server and client (-1 = not pinned)
+	int server_cpu;
+	int client_cpu;
+	const char* relation;
+
+	// Time source
+	const char* clock;
+	double clock_frequency;
+	bench_t clock_overhead;
+
+} Results;
+
+/******************** INTERFACE ********************/
+
+extern const double result_percentiles[RESULT_PERCENTILES];
+
+OutputFormat parse_format(const char* name);
+
+/**
+ * Prints the results of a run in the format requested on the command line.
+ *
+ * JSON is printed as a single line (JSON Lines), so that it can be appended
+ * to a file across runs. CSV is printed as a header row, once per process,
+ * followed by a value row per run. Runs appended to the same file use
+ * FORMAT_CSV_NOHEADER after the first one.
+ *
+ * \param results The results of the run.
+ * \param args The arguments the run was started with.
+ */
+void print_results(const Results* results, const struct Arguments* args);
+
+#endif /* IPC_BENCH_RESULTS_H */
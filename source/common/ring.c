@@ -0,0 +1,78 @@
+#include <assert.h>
+
+#include "common/ring.h"
+
+static size_t slot_size(int message_size) {
+	// Pad every slot to whole cache lines, so that the producer
+	// never writes to the line the consumer is reading from
+	return (message_size + CACHE_LINE - 1) & ~(size_t)(CACHE_LINE - 1);
+}
+
+int ring_slots(int message_size) {
+	size_t bytes = slot_size(message_size);
+	int slots = 2;
+
+	// Largest power of two that fits, but at least double buffering
+	while (bytes * slots * 2 <= RING_BYTES) {
+		slots *= 2;
+	}
+
+	return slots;
+}
+
+size_t ring_memory_size(int message_size, int slots) {
+	return sizeof(RingHeader) + slot_size(message_size) * slots;
+}
+
+void ring_setup(Ring *ring, void *memory, int message_size, int slots) {
+	assert(slots > 0 && (slots & (slots - 1)) == 0);
+	assert(((size_t)memory & (CACHE_LINE - 1)) == 0);
+
+	ring->header = (RingHeader *)memory;
+	ring->slot_size = slot_size(message_size);
+	ring->mask = slots - 1;
+}
+
+void *ring_write_slot(Ring *ring) {
+	RingHeader *header = ring->header;
+	const size_t head = atomic_load_explicit(&header->head, memory_order_relaxed);
+
+	// Only look at the consumer's index when the ring seems full
+	if (head - header->cached_tail > ring->mask) {
+		do {
+			header->cached_tail =
+					atomic_load_explicit(&header->tail, memory_order_acquire);
+		} while (head - header->cached_tail > ring->mask);
+	}
+
+	return header->slots + (head & ring->mask) * ring->slot_size;
+}
+
+void ring_publish(Ring *ring) {
+	RingHeader *header = ring->header;
+	const size_t head = atomic_load_explicit(&header->head, memory_order_relaxed);
+
+	atomic_store_explicit(&header->head, head + 1, memory_order_release);
+}
+
+void *ring_read_slot(Ring *ring) {
+	RingHeader *header = ring->header;
+	const size_t tail = atomic_load_explicit(&header->tail, memory_order_relaxed);
+
+	// Only look at the producer's index when the ring seems empty
+	if (tail == header->cached_head) {
+		do {
+			header->cached_head =
+					atomic_load_explicit(&header->head, memory_order_acquire);
+		} while (tail == header->cached_head);
+	}
+
+	return header->slots + (tail & ring->mask) * ring->slot_size;
+}
+
+void ring_release(Ring *ring) {
+	RingHeader *header = ring->header;
+	const size_t tail = atomic_load_explicit(&header->tail, memory_order_relaxed);
+
+	atomic_store_explicit(&header->tail, tail + 1, memory_order_release);
+}
@@ -0,0 +1,73 @@
+#ifndef IPC_BENCH_RING_H
+#define IPC_BENCH_RING_H
+
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+#include "common/utility.h"
+
+/******************** DEFINITIONS ********************/
+
+// Default number of bytes of slots per ring (rounded to a power of two slots)
+#define RING_BYTES (1 << 20)
+
+// The part of a ring that lives in shared memory. Producer and consumer
+// indices are on cache lines of their own, so that each side only writes
+// to its own line. The indices count messages and never wrap, a slot is
+// found by masking them with the capacity.
+typedef struct RingHeader {
+	// Next slot to write, written by the producer only
+	alignas(CACHE_LINE) atomic_size_t head;
+	// The producer's last view of the tail (saves reading the consumer's line)
+	size_t cached_tail;
+
+	// Next slot to read, written by the consumer only
+	alignas(CACHE_LINE) atomic_size_t tail;
+	// The consumer's last view of the head
+	size_t cached_head;
+
+	// The slots follow on the next cache line
+	alignas(CACHE_LINE) char slots[];
+} RingHeader;
+
+// A process-local handle to a ring in shared memory. Both sides derive the
+// same layout from the message size, so nothing has to be negotiated and a
+// zero-filled segment is an empty ring.
+typedef struct Ring {
+	RingHeader *header;
+	size_t slot_size;
+	size_t mask;
+} Ring;
+
+/******************** INTERFACE ********************/
+
+// The number of slots of a ring for messages of the given size
+int ring_slots(int message_size);
+
+// The bytes of shared memory needed for a ring (a multiple of CACHE_LINE)
+size_t ring_memory_size(int message_size, int slots);
+
+/**
+ * Sets up a handle to a ring at the given (cache-line aligned) memory.
+ *
+ * \param ring The handle to set up.
+ * \param memory The shared memory of the ring, zero-filled when created.
+ * \param message_size The size of every message in bytes.
+ * \param slots The capacity of the ring, a power of two.
+ */
+void ring_setup(Ring *ring, void *memory, int message_size, int slots);
+
+// Spins until a slot is free and returns it (producer only)
+void *ring_write_slot(Ring *ring);
+
+// Makes the slot returned by ring_write_slot() visible to the consumer
+void ring_publish(Ring *ring);
+
+// Spins until a message is available and returns its slot (consumer only)
+void *ring_read_slot(Ring *ring);
+
+// Hands the slot returned by ring_read_slot() back to the producer
+void ring_release(Ring *ring);
+
+#endif /* IPC_BENCH_RING_H */
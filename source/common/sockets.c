@@ -145,15 +145,23 @@ int set_io_flag(int socket_fd, int flag) {
 }
 
 int receive(int connection, void* buffer, int size, int busy_waiting) {
-	if (busy_waiting) {
-		while (recv(connection, buffer, size, 0) < size) {
-			if (errno != EAGAIN) return -1;
+	ssize_t bytes;
+	int calls = 0;
+
+	// Stream sockets may return a message in parts
+	while (size > 0) {
+		++calls;
+		if ((bytes = recv(connection, buffer, size, 0)) == -1) {
+			if (busy_waiting && errno == EAGAIN) continue;
+			return -1;
 		}
-	} else if (recv(connection, buffer, size, 0) < size) {
-		return -1;
+		if (bytes == 0) return -1;
+
+		buffer = (char*)buffer + bytes;
+		size -= bytes;
 	}
 
-	return 0;
+	return calls;
 }
 
 int get_socket_flags(int socket_fd) {
@@ -9,6 +9,9 @@
 
 #define BUFFER_SIZE 64000
 
+// Seconds after which a receive over UDP assumes a datagram was dropped
+#define LOSS_TIMEOUT 5
+
 typedef enum Direction { SEND, RECEIVE } Direction;
 
 struct timeval;
@@ -37,6 +40,7 @@ bool socket_is_non_blocking(int socket_fd);
 
 int set_io_flag(int socket_fd, int flag);
 
+// Receives a whole message, returns the recv() calls it took or -1 on error
 int receive(int connection, void* buffer, int size, int busy_waiting);
 
 #endif /* SOCKETS_H */
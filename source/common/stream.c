@@ -0,0 +1,209 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/arguments.h"
+#include "common/benchmarks.h"
+#include "common/stream.h"
+#include "common/utility.h"
+
+// Acknowledgements per measurement in stream mode when it ends early
+#define STREAM_ACKS 100
+
+const char *mode_name(int mode) {
+	switch (mode) {
+		case MODE_STREAM: return "stream";
+		case MODE_WINDOW: return "window";
+		case MODE_BROADCAST: return "broadcast";
+		case MODE_OPEN_LOOP: return "open-loop";
+		default: return "pingpong";
+	}
+}
+
+// Number of messages the client acknowledges at once
+static int batch_size(const Arguments *args, int total) {
+	// Half a window, so that the server can go on sending
+	// while an acknowledgement is on its way back
+	if (args->mode == MODE_WINDOW) {
+		return (args->window + 1) / 2;
+	}
+
+	// Once at the end, unless a time-based or steady warmup makes the
+	// measurement end before it: then often enough that it ends within
+	// a few messages of its last one
+	if (total == args->count + args->warmup) {
+		return total;
+	}
+
+	return (args->count < STREAM_ACKS) ? 1 : args->count / STREAM_ACKS;
+}
+
+// Whether the next sample is the last one that is measured
+static bool ends_measurement(const Benchmarks *bench, const Arguments *args) {
+	// clang-format off
+	return bench->phase == PHASE_MEASURE &&
+				 bench->histogram.count + 1 == (bench_t)args->count;
+	// clang-format on
+}
+
+static void send_in_window(const Channel *channel,
+													 const Arguments *args,
+													 void *buffer,
+													 int sent,
+													 int *acked,
+													 int batch) {
+	while (args->mode == MODE_WINDOW && sent - *acked >= args->window) {
+		channel->wait_for_ack(channel->context);
+		*acked += batch;
+	}
+
+	channel->send(channel->context, buffer, args->size);
+}
+
+void stream_server(const Channel *channel, Arguments *args) {
+	Benchmarks bench;
+	const int total = total_messages(args);
+	const int batch = batch_size(args, total);
+	void *buffer = malloc(args->size);
+	int sent;
+	int acked = 0;
+	bool last;
+
+	memset(buffer, '*', args->size);
+	setup_benchmarks(&bench);
+	if (channel->peer > 0) {
+		benchmarks_count_peer(&bench, channel->peer);
+	}
+
+	for (sent = 0; sent < total; ++sent) {
+		bench.single_start = now();
+		last = sent + 1 == total || ends_measurement(&bench, args);
+
+		send_in_window(channel, args, buffer, sent, &acked, batch);
+
+		// A message has only arrived once it is acknowledged, and the client
+		// acknowledges whole batches, so the measurement ends with the batch
+		// of its last message
+		if (last) {
+			while ((sent + 1) % batch != 0 && sent + 1 < total) {
+				send_in_window(channel, args, buffer, ++sent, &acked, batch);
+			}
+			while (acked < sent + 1) {
+				channel->wait_for_ack(channel->context);
+				acked += batch;
+			}
+		}
+
+		benchmark(&bench);
+	}
+
+	evaluate(&bench, args);
+	free(buffer);
+}
+
+void stream_client(const Channel *channel, Arguments *args) {
+	const int total = total_messages(args);
+	const int batch = batch_size(args, total);
+	void *buffer = malloc(args->size);
+	int received;
+
+	for (received = 1; received <= total; ++received) {
+		channel->receive(channel->context, buffer, args->size);
+
+		if (received % batch == 0 || received == total) {
+			channel->acknowledge(channel->context);
+		}
+	}
+
+	free(buffer);
+}
+
+static void descriptor_send(void *context, void *buffer, int size) {
+	write_all(((Descriptors *)context)->data, buffer, size);
+}
+
+static void descriptor_receive(void *context, void *buffer, int size) {
+	read_all(((Descriptors *)context)->data, buffer, size);
+}
+
+static void descriptor_acknowledge(void *context) {
+	write_all(((Descriptors *)context)->ack, "", 1);
+}
+
+static void descriptor_wait_for_ack(void *context) {
+	char ack;
+	read_all(((Descriptors *)context)->ack, &ack, 1);
+}
+
+void descriptor_channel(Channel *channel, Descriptors *descriptors) {
+	channel->context = descriptors;
+	channel->send = descriptor_send;
+	channel->receive = descriptor_receive;
+	channel->acknowledge = descriptor_acknowledge;
+	channel->wait_for_ack = descriptor_wait_for_ack;
+	channel->peer = 0;
+}
+
+static void ring_send(void *context, void *buffer, int size) {
+	Ring *ring = &((RingChannel *)context)->ring;
+
+	memcpy(ring_write_slot(ring), buffer, size);
+	ring_publish(ring);
+}
+
+static void ring_receive(void *context, void *buffer, int size) {
+	Ring *ring = &((RingChannel *)context)->ring;
+
+	memcpy(buffer, ring_read_slot(ring), size);
+	ring_release(ring);
+}
+
+static void ring_acknowledge(void *context) {
+	atomic_fetch_add_explicit(((RingChannel *)context)->acks,
+														1,
+														memory_order_release);
+}
+
+static void ring_wait_for_ack(void *context) {
+	RingChannel *channel = (RingChannel *)context;
+
+	// clang-format off
+	while (atomic_load_explicit(channel->acks, memory_order_acquire) ==
+				 channel->seen)
+		;
+	// clang-format on
+
+	++channel->seen;
+}
+
+size_t ring_channel_size(int message_size) {
+	// The acknowledgement counter takes the first cache line
+	return CACHE_LINE + ring_memory_size(message_size, ring_slots(message_size));
+}
+
+size_t message_memory_size(const Arguments *args) {
+	if (args->mode == MODE_PINGPONG) {
+		return args->size;
+	}
+
+	return ring_channel_size(args->size);
+}
+
+void ring_channel(Channel *channel,
+									RingChannel *context,
+									void *memory,
+									int message_size) {
+	context->acks = (atomic_int *)memory;
+	context->seen = 0;
+	// clang-format off
+	ring_setup(&context->ring, (char *)memory + CACHE_LINE,
+						 message_size, ring_slots(message_size));
+	// clang-format on
+
+	channel->context = context;
+	channel->send = ring_send;
+	channel->receive = ring_receive;
+	channel->acknowledge = ring_acknowledge;
+	channel->wait_for_ack = ring_wait_for_ack;
+	channel->peer = 0;
+}
@@ -0,0 +1,102 @@
+#ifndef IPC_BENCH_STREAM_H
+#define IPC_BENCH_STREAM_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#include "common/ring.h"
+
+struct Arguments;
+
+/******************** DEFINITIONS ********************/
+
+// How the server and client exchange messages (--mode)
+typedef enum Mode {
+	// The client echoes every message before the server sends the next one
+	MODE_PINGPONG,
+	// The server sends without limit, the client acknowledges once at the end
+	MODE_STREAM,
+	// The server keeps at most a window of messages in flight
+	MODE_WINDOW,
+	// One server publishes every message to all clients (ipc-bench only)
+	MODE_BROADCAST,
+	// Requests are sent at a fixed rate, regardless of replies (ipc-bench only)
+	MODE_OPEN_LOOP
+} Mode;
+
+// A one-directional channel from the server to the client, with
+// acknowledgements going back. The stream and window modes only
+// need these four operations from a transport.
+typedef struct Channel {
+	// Transport-specific state passed to the operations
+	void *context;
+
+	// Sends a message from the server
+	void (*send)(void *context, void *buffer, int size);
+	// Receives a message on the client
+	void (*receive)(void *context, void *buffer, int size);
+
+	// Acknowledges a batch of messages from the client
+	void (*acknowledge)(void *context);
+	// Waits for an acknowledgement on the server
+	void (*wait_for_ack)(void *context);
+
+	// The client's thread, if the server knows it (0 = unknown), so that
+	// its CPU usage is reported as well
+	pid_t peer;
+} Channel;
+
+// Context of a channel over file descriptors (pipes, FIFOs, sockets)
+typedef struct Descriptors {
+	// The server writes messages to this one and the client reads them
+	int data;
+	// The other direction, may be the same descriptor
+	int ack;
+} Descriptors;
+
+// Context of a channel over a ring in shared memory
+typedef struct RingChannel {
+	Ring ring;
+	// Acknowledgements so far, on a cache line of its own
+	atomic_int *acks;
+	// Acknowledgements the server has already seen
+	int seen;
+} RingChannel;
+
+/******************** INTERFACE ********************/
+
+const char *mode_name(int mode);
+
+/**
+ * Sends all messages over the channel as configured by --mode and prints
+ * the results. Every sample is the time the server spent on one message,
+ * including waiting for the window to open. The last one includes waiting
+ * for the final acknowledgement, so the total time covers every message
+ * having arrived.
+ *
+ * \param channel The channel to the client.
+ * \param args The parsed arguments.
+ */
+void stream_server(const Channel *channel, struct Arguments *args);
+
+// Receives all messages over the channel and acknowledges them in batches
+void stream_client(const Channel *channel, struct Arguments *args);
+
+// Sets up a channel reading and writing the descriptors (pipes, sockets)
+void descriptor_channel(Channel *channel, Descriptors *descriptors);
+
+// The bytes of shared memory needed for a ring channel
+size_t ring_channel_size(int message_size);
+
+// The bytes of shared memory for the messages of the configured mode:
+// one message for ping-pong, a ring channel otherwise
+size_t message_memory_size(const struct Arguments *args);
+
+// Sets up a channel over the (cache-line aligned, zero-filled) memory
+void ring_channel(Channel *channel,
+									RingChannel *context,
+									void *memory,
+									int message_size);
+
+#endif /* IPC_BENCH_STREAM_H */
@@ -0,0 +1,124 @@
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common/topology.h"
+
+#define CPU_PATH "/sys/devices/system/cpu/cpu%d"
+
+static FILE* open_attribute(int cpu, const char* attribute) {
+	char path[128];
+
+	snprintf(path, sizeof path, CPU_PATH "/%s", cpu, attribute);
+
+	return fopen(path, "r");
+}
+
+// Returns the integer in a sysfs attribute, or -1 if it does not exist
+static int read_number(int cpu, const char* attribute) {
+	FILE* file;
+	int value = -1;
+
+	if ((file = open_attribute(cpu, attribute)) == NULL) return -1;
+	if (fscanf(file, "%d", &value) != 1) value = -1;
+	fclose(file);
+
+	return value;
+}
+
+// Checks if a cpu list attribute such as "0-3,8-11" contains the cpu
+static int list_contains(int cpu, const char* attribute, int other) {
+	FILE* file;
+	int first, last;
+	int found = 0;
+
+	if ((file = open_attribute(cpu, attribute)) == NULL) return 0;
+
+	while (!found && fscanf(file, "%d", &first) == 1) {
+		if (fscanf(file, "-%d", &last) != 1) last = first;
+		found = (other >= first && other <= last);
+
+		// Skip the comma
+		if (fgetc(file) != ',') break;
+	}
+
+	fclose(file);
+
+	return found;
+}
+
+// The shared_cpu_list of the cache with the highest level
+static int share_last_level_cache(int first, int second) {
+	char attribute[64];
+	int index;
+	int level;
+	int highest = -1;
+	int shared = 0;
+
+	for (index = 0;; ++index) {
+		snprintf(attribute, sizeof attribute, "cache/index%d/level", index);
+		if ((level = read_number(first, attribute)) == -1) break;
+		if (level < highest) continue;
+
+		highest = level;
+		snprintf(attribute, sizeof attribute, "cache/index%d/shared_cpu_list", index);
+		shared = list_contains(first, attribute, second);
+	}
+
+	return shared;
+}
+
+static int numa_node(int cpu) {
+	char path[64];
+	struct dirent* entry;
+	DIR* directory;
+	int node = 0;
+
+	snprintf(path, sizeof path, CPU_PATH, cpu);
+	if ((directory = opendir(path)) == NULL) return 0;
+
+	// cpuN has a nodeM link to the NUMA node it belongs to
+	while ((entry = readdir(directory)) != NULL) {
+		if (sscanf(entry->d_name, "node%d", &node) == 1) break;
+	}
+
+	closedir(directory);
+
+	return node;
+}
+
+CpuRelation cpu_relation(int first, int second) {
+	if (first < 0 || second < 0) return RELATION_UNPINNED;
+	if (first == second) return RELATION_SAME_CPU;
+
+	if (list_contains(first, "topology/thread_siblings_list", second)) {
+		return RELATION_SMT_SIBLING;
+	}
+	if (share_last_level_cache(first, second)) {
+		return RELATION_SAME_LLC;
+	}
+	if (numa_node(first) != numa_node(second)) {
+		return RELATION_CROSS_NUMA;
+	}
+
+	// clang-format off
+	if (read_number(first, "topology/physical_package_id") ==
+			read_number(second, "topology/physical_package_id")) {
+		return RELATION_SAME_SOCKET;
+	}
+	// clang-format on
+
+	return RELATION_CROSS_SOCKET;
+}
+
+const char* relation_name(CpuRelation relation) {
+	switch (relation) {
+		case RELATION_SAME_CPU: return "same-cpu";
+		case RELATION_SMT_SIBLING: return "smt-sibling";
+		case RELATION_SAME_LLC: return "same-llc";
+		case RELATION_SAME_SOCKET: return "same-socket";
+		case RELATION_CROSS_SOCKET: return "cross-socket";
+		case RELATION_CROSS_NUMA: return "cross-numa";
+		default: return "unpinned";
+	}
+}
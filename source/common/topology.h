@@ -0,0 +1,38 @@
+#ifndef IPC_BENCH_TOPOLOGY_H
+#define IPC_BENCH_TOPOLOGY_H
+
+/******************** DEFINITIONS ********************/
+
+// How close two CPUs are to each other, from closest to farthest
+typedef enum CpuRelation {
+	// At least one side is not pinned
+	RELATION_UNPINNED,
+	// Both sides share one hardware thread
+	RELATION_SAME_CPU,
+	// Hyper-threads of the same physical core
+	RELATION_SMT_SIBLING,
+	// Different cores sharing the last-level cache
+	RELATION_SAME_LLC,
+	// Same package and NUMA node, but different last-level caches
+	RELATION_SAME_SOCKET,
+	// Different packages on the same NUMA node
+	RELATION_CROSS_SOCKET,
+	// Different NUMA nodes
+	RELATION_CROSS_NUMA
+} CpuRelation;
+
+#define RELATION_COUNT (RELATION_CROSS_NUMA + 1)
+
+/******************** INTERFACE ********************/
+
+/**
+ * Classifies the relationship between two CPUs using the topology in sysfs.
+ *
+ * \param first The first logical CPU, or -1 if not pinned.
+ * \param second The second logical CPU, or -1 if not pinned.
+ */
+CpuRelation cpu_relation(int first, int second);
+
+const char* relation_name(CpuRelation relation);
+
+#endif /* IPC_BENCH_TOPOLOGY_H */
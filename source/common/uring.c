@@ -0,0 +1,327 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "common/arguments.h"
+#include "common/benchmarks.h"
+#include "common/results.h"
+#include "common/stream.h"
+#include "common/uring.h"
+#include "common/utility.h"
+
+// A round trip needs two entries, the rest is headroom
+#define URING_ENTRIES 8
+
+// How long an idle submission queue poller spins before it sleeps
+#define SQPOLL_IDLE_MS 1000
+
+// Indices of the registered descriptors
+enum { FILE_IN, FILE_OUT };
+
+static int enter(Uring *uring, unsigned submit, unsigned wait, unsigned flags) {
+	int result;
+
+	++uring->enters;
+
+	// Nothing was submitted if the call was interrupted
+	// clang-format off
+	while ((result = syscall(__NR_io_uring_enter, uring->descriptor,
+													 submit, wait, flags, NULL, 0)) == -1) {
+		if (errno != EINTR) {
+			throw("Error entering io_uring");
+		}
+	}
+	// clang-format on
+
+	return result;
+}
+
+static void *map_ring(Uring *uring, size_t size, off_t offset) {
+	void *memory;
+
+	// clang-format off
+	memory = mmap(NULL, size, PROT_READ | PROT_WRITE,
+								MAP_SHARED | MAP_POPULATE, uring->descriptor, offset);
+	// clang-format on
+	if (memory == MAP_FAILED) {
+		throw("Error mapping io_uring");
+	}
+
+	return memory;
+}
+
+static void register_resources(Uring *uring, int in, int out, int size) {
+	int files[2] = {in, out};
+	struct iovec buffer;
+
+	// clang-format off
+	uring->buffer = mmap(NULL, size, PROT_READ | PROT_WRITE,
+											 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	// clang-format on
+	if (uring->buffer == MAP_FAILED) {
+		throw("Error allocating io_uring buffer");
+	}
+	uring->buffer_size = size;
+
+	// Pinned once, instead of on every read and write
+	buffer.iov_base = uring->buffer;
+	buffer.iov_len = size;
+	// clang-format off
+	if (syscall(__NR_io_uring_register, uring->descriptor,
+							IORING_REGISTER_BUFFERS, &buffer, 1) == -1) {
+		throw("Error registering io_uring buffer");
+	}
+
+	// Looked up once, instead of on every read and write
+	if (syscall(__NR_io_uring_register, uring->descriptor,
+							IORING_REGISTER_FILES, files, 2) == -1) {
+		throw("Error registering io_uring files");
+	}
+	// clang-format on
+}
+
+void uring_create(Uring *uring, int entries, int completions, bool sqpoll) {
+	struct io_uring_params params;
+	size_t sq_size, cq_size;
+	char *rings;
+
+	memset(&params, 0, sizeof params);
+	if (sqpoll) {
+		params.flags = IORING_SETUP_SQPOLL;
+		params.sq_thread_idle = SQPOLL_IDLE_MS;
+	}
+	if (completions > 0) {
+		params.flags |= IORING_SETUP_CQSIZE;
+		params.cq_entries = completions;
+	}
+
+	uring->sqpoll = sqpoll;
+	uring->enters = 0;
+	uring->queued = 0;
+	uring->buffer = NULL;
+	uring->descriptor = syscall(__NR_io_uring_setup, entries, &params);
+	if (uring->descriptor == -1) {
+		throw("Error setting up io_uring");
+	}
+	if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+		terminate("io_uring needs a kernel with IORING_FEAT_SINGLE_MMAP (5.4)\n");
+	}
+
+	// Both rings share one mapping
+	sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	cq_size = params.cq_off.cqes +
+						params.cq_entries * sizeof(struct io_uring_cqe);
+	uring->rings_size = sq_size > cq_size ? sq_size : cq_size;
+	uring->rings = map_ring(uring, uring->rings_size, IORING_OFF_SQ_RING);
+	rings = uring->rings;
+
+	uring->entries_size = params.sq_entries * sizeof(struct io_uring_sqe);
+	uring->entries = map_ring(uring, uring->entries_size, IORING_OFF_SQES);
+
+	uring->sq_head = (unsigned *)(rings + params.sq_off.head);
+	uring->sq_tail = (unsigned *)(rings + params.sq_off.tail);
+	uring->sq_mask = (unsigned *)(rings + params.sq_off.ring_mask);
+	uring->sq_flags = (unsigned *)(rings + params.sq_off.flags);
+	uring->sq_array = (unsigned *)(rings + params.sq_off.array);
+
+	uring->cq_head = (unsigned *)(rings + params.cq_off.head);
+	uring->cq_tail = (unsigned *)(rings + params.cq_off.tail);
+	uring->cq_mask = (unsigned *)(rings + params.cq_off.ring_mask);
+	uring->completions = (struct io_uring_cqe *)(rings + params.cq_off.cqes);
+}
+
+void uring_setup(Uring *uring, int in, int out, int size, bool sqpoll) {
+	uring_create(uring, URING_ENTRIES, 0, sqpoll);
+	register_resources(uring, in, out, size);
+}
+
+void uring_destroy(Uring *uring) {
+	if (uring->buffer != NULL) {
+		munmap(uring->buffer, uring->buffer_size);
+	}
+	munmap(uring->entries, uring->entries_size);
+	munmap(uring->rings, uring->rings_size);
+	close(uring->descriptor);
+}
+
+struct io_uring_sqe *uring_entry(Uring *uring) {
+	// Only we move the tail, the kernel moves the head
+	const unsigned index = (*uring->sq_tail + uring->queued) & *uring->sq_mask;
+	struct io_uring_sqe *entry = &uring->entries[index];
+
+	memset(entry, 0, sizeof *entry);
+	uring->sq_array[index] = index;
+	++uring->queued;
+
+	return entry;
+}
+
+// Queues a fixed read or write of the registered buffer
+static void push(Uring *uring,
+								 int operation,
+								 int file,
+								 int offset,
+								 int length,
+								 unsigned flags) {
+	struct io_uring_sqe *entry = uring_entry(uring);
+
+	entry->opcode = operation;
+	entry->flags = IOSQE_FIXED_FILE | flags;
+	entry->fd = file;
+	// Pipes and sockets are not seekable
+	entry->off = (uint64_t)-1;
+	entry->addr = (uintptr_t)uring->buffer + offset;
+	entry->len = length;
+	entry->buf_index = 0;
+	entry->user_data = operation;
+}
+
+void uring_submit(Uring *uring, unsigned wait) {
+	const unsigned count = uring->queued;
+
+	// clang-format off
+	__atomic_store_n(
+		uring->sq_tail, *uring->sq_tail + count, __ATOMIC_RELEASE);
+	// clang-format on
+	uring->queued = 0;
+
+	if (!uring->sqpoll) {
+		// Submit and wait for the completions in one go
+		enter(uring, count, wait, wait > 0 ? IORING_ENTER_GETEVENTS : 0);
+		return;
+	}
+
+	// The poller picks the entries up by itself, unless it went to sleep
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (__atomic_load_n(uring->sq_flags, __ATOMIC_RELAXED) &
+			IORING_SQ_NEED_WAKEUP) {
+		enter(uring, 0, 0, IORING_ENTER_SQ_WAKEUP);
+	}
+}
+
+int uring_complete(Uring *uring, uint64_t *data) {
+	const unsigned head = *uring->cq_head;
+	struct io_uring_cqe *completion;
+	int result;
+
+	// Spin with a poller, there is no system call to save otherwise
+	while (head == __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE)) {
+		if (!uring->sqpoll) {
+			enter(uring, 0, 1, IORING_ENTER_GETEVENTS);
+		}
+	}
+
+	completion = &uring->completions[head & *uring->cq_mask];
+	*data = completion->user_data;
+	result = completion->res;
+	__atomic_store_n(uring->cq_head, head + 1, __ATOMIC_RELEASE);
+
+	return result;
+}
+
+void uring_exchange(Uring *uring, int send_size, int receive_size) {
+	int sent = 0, received = 0;
+	int pending, result;
+	uint64_t operation;
+
+	while (sent < send_size || received < receive_size) {
+		pending = 0;
+		if (sent < send_size) {
+			// The read only starts once the write is complete
+			// clang-format off
+			push(uring, IORING_OP_WRITE_FIXED, FILE_OUT, sent, send_size - sent,
+					 received < receive_size ? IOSQE_IO_LINK : 0);
+			// clang-format on
+			++pending;
+		}
+		if (received < receive_size) {
+			// clang-format off
+			push(uring, IORING_OP_READ_FIXED, FILE_IN, received,
+					 receive_size - received, 0);
+			// clang-format on
+			++pending;
+		}
+
+		uring_submit(uring, pending);
+
+		for (; pending > 0; --pending) {
+			result = uring_complete(uring, &operation);
+
+			// A short write cancels the linked read, and non-blocking
+			// descriptors (--busy) may have nothing yet: both are retried
+			if (result == -ECANCELED || result == -EAGAIN || result == -EINTR) {
+				continue;
+			}
+			if (result < 0) {
+				errno = -result;
+				throw("Error in io_uring operation");
+			}
+
+			if (operation == IORING_OP_WRITE_FIXED) {
+				sent += result;
+			} else if (result == 0) {
+				terminate("Peer closed the connection\n");
+			} else {
+				received += result;
+			}
+		}
+	}
+}
+
+static void check_mode(const Arguments *args) {
+	if (args->mode != MODE_PINGPONG) {
+		terminate("--uring and --sqpoll only support --mode pingpong\n");
+	}
+}
+
+void uring_server(int in, int out, Arguments *args, bool sqpoll) {
+	const int total = total_messages(args);
+	Benchmarks bench;
+	Results results;
+	Uring uring;
+	int message;
+
+	check_mode(args);
+	uring_setup(&uring, in, out, args->size, sqpoll);
+	memset(uring.buffer, '*', args->size);
+	setup_benchmarks(&bench);
+
+	for (message = total; message > 0; --message) {
+		bench.single_start = now();
+
+		uring_exchange(&uring, args->size, args->size);
+
+		benchmark(&bench);
+	}
+
+	name_variant(args, sqpoll ? "-sqpoll" : "-uring");
+	summarize(&bench, args, &results);
+	results.syscalls = uring.enters / (double)total;
+	print_results(&results, args);
+
+	uring_destroy(&uring);
+}
+
+void uring_client(int in, int out, Arguments *args, bool sqpoll) {
+	Uring uring;
+	int message;
+
+	check_mode(args);
+	uring_setup(&uring, in, out, args->size, sqpoll);
+
+	// Every reply goes out together with the receive of the next message
+	uring_exchange(&uring, 0, args->size);
+	for (message = total_messages(args) - 1; message > 0; --message) {
+		uring_exchange(&uring, args->size, args->size);
+	}
+	uring_exchange(&uring, args->size, 0);
+
+	uring_destroy(&uring);
+}
@@ -0,0 +1,128 @@
+#ifndef IPC_BENCH_URING_H
+#define IPC_BENCH_URING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct Arguments;
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+/******************** DEFINITIONS ********************/
+
+// An io_uring instance set up with the raw system calls (there is no
+// liburing dependency), with the two descriptors of a transport registered
+// as fixed files and one message buffer registered for fixed reads and writes
+typedef struct Uring {
+	int descriptor;
+
+	// Whether a kernel thread polls the submission queue (--sqpoll)
+	bool sqpoll;
+
+	// The rings shared with the kernel
+	void *rings;
+	size_t rings_size;
+	struct io_uring_sqe *entries;
+	size_t entries_size;
+
+	unsigned *sq_head;
+	unsigned *sq_tail;
+	unsigned *sq_mask;
+	unsigned *sq_flags;
+	unsigned *sq_array;
+
+	unsigned *cq_head;
+	unsigned *cq_tail;
+	unsigned *cq_mask;
+	struct io_uring_cqe *completions;
+
+	// Entries filled in but not submitted yet
+	unsigned queued;
+
+	// The registered buffer (NULL if there is none)
+	void *buffer;
+	size_t buffer_size;
+
+	// Calls of io_uring_enter() so far
+	long enters;
+} Uring;
+
+/******************** INTERFACE ********************/
+
+/**
+ * Sets up a ring for exchanging messages over two descriptors.
+ *
+ * Terminates if the kernel does not support io_uring (or it is disabled).
+ *
+ * \param uring The ring to set up.
+ * \param in The descriptor messages are read from.
+ * \param out The descriptor messages are written to (may be the same).
+ * \param size The largest message, the size of the registered buffer.
+ * \param sqpoll Whether the kernel polls for submissions, so that
+ *               submitting needs no system call while the poller is awake.
+ */
+void uring_setup(Uring *uring, int in, int out, int size, bool sqpoll);
+
+/**
+ * Sets up a bare ring, without registered files or buffers.
+ *
+ * \param uring The ring to set up.
+ * \param entries The size of the submission queue.
+ * \param completions The size of the completion queue (0 = twice the
+ *                    submission queue).
+ * \param sqpoll Whether the kernel polls for submissions.
+ */
+void uring_create(Uring *uring, int entries, int completions, bool sqpoll);
+
+void uring_destroy(Uring *uring);
+
+// Returns the next free submission queue entry, zero-filled
+struct io_uring_sqe *uring_entry(Uring *uring);
+
+/**
+ * Submits the entries filled in so far.
+ *
+ * Without a poller, this is one io_uring_enter() that also waits for the
+ * given number of completions. With a poller, it only wakes it if needed.
+ *
+ * \param uring The ring.
+ * \param wait Completions to wait for.
+ */
+void uring_submit(Uring *uring, unsigned wait);
+
+// Takes the next completion (waiting for it), returning its result and
+// storing its user data
+int uring_complete(Uring *uring, uint64_t *data);
+
+/**
+ * Writes a message from the buffer and then reads one into it.
+ *
+ * Both are submitted at once, the read linked behind the write, so a round
+ * trip takes a single io_uring_enter() (none with a busy poller) unless a
+ * stream returns a message in parts. Either size may be zero.
+ *
+ * \param uring The ring.
+ * \param send_size Bytes to write.
+ * \param receive_size Bytes to read afterwards.
+ */
+void uring_exchange(Uring *uring, int send_size, int receive_size);
+
+/**
+ * Runs the server side of a ping-pong over io_uring and prints the results.
+ *
+ * Like the plain loops of the transports, but every send is submitted
+ * together with the receive of the echo. The results include the system
+ * calls the server made per message.
+ *
+ * \param in The descriptor the echoes arrive on.
+ * \param out The descriptor the messages are sent on.
+ * \param args The parsed arguments.
+ * \param sqpoll Whether to use a submission queue polling thread.
+ */
+void uring_server(int in, int out, struct Arguments *args, bool sqpoll);
+
+// Echoes every message, submitting each reply with the next receive
+void uring_client(int in, int out, struct Arguments *args, bool sqpoll);
+
+#endif /* IPC_BENCH_URING_H */
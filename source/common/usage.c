@@ -0,0 +1,156 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "common/usage.h"
+#include "common/utility.h"
+
+static double timeval_ns(const struct timeval* time) {
+	return time->tv_sec * 1e9 + time->tv_usec * 1e3;
+}
+
+static bool read_schedstat(const char* directory, CpuUsage* usage) {
+	unsigned long long running, waiting;
+	char path[64];
+	FILE* file;
+	int read;
+
+	// "<ns on a CPU> <ns on a runqueue> <timeslices>"
+	snprintf(path, sizeof path, "%s/schedstat", directory);
+	if ((file = fopen(path, "r")) == NULL) return false;
+	read = fscanf(file, "%llu %llu", &running, &waiting);
+	fclose(file);
+
+	if (read != 2) return false;
+
+	usage->cpu = running;
+	usage->waiting = waiting;
+
+	return true;
+}
+
+static bool read_times(const char* directory, CpuUsage* usage) {
+	unsigned long user, system;
+	char line[1024];
+	char path[64];
+	char* fields;
+	FILE* file;
+
+	snprintf(path, sizeof path, "%s/stat", directory);
+	if ((file = fopen(path, "r")) == NULL) return false;
+	fields = fgets(line, sizeof line, file);
+	fclose(file);
+
+	// The name may contain spaces and parentheses, the fields follow the last
+	if (fields == NULL || (fields = strrchr(line, ')')) == NULL) return false;
+
+	// clang-format off
+	if (sscanf(fields + 1,
+						 " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+						 &user, &system) != 2) {
+		return false;
+	}
+	// clang-format on
+
+	usage->user = user * 1e9 / sysconf(_SC_CLK_TCK);
+	usage->system = system * 1e9 / sysconf(_SC_CLK_TCK);
+
+	return true;
+}
+
+static bool read_switches(const char* directory, CpuUsage* usage) {
+	unsigned long count;
+	char line[256];
+	char path[64];
+	FILE* file;
+	int found = 0;
+
+	snprintf(path, sizeof path, "%s/status", directory);
+	if ((file = fopen(path, "r")) == NULL) return false;
+
+	while (fgets(line, sizeof line, file) != NULL) {
+		if (sscanf(line, "voluntary_ctxt_switches: %lu", &count) == 1) {
+			usage->voluntary = count;
+			++found;
+		} else if (sscanf(line, "nonvoluntary_ctxt_switches: %lu", &count) == 1) {
+			usage->involuntary = count;
+			++found;
+		}
+	}
+	fclose(file);
+
+	return found == 2;
+}
+
+bool usage_read(pid_t thread, CpuUsage* usage) {
+	struct rusage own;
+	char directory[32];
+
+	if (thread == 0) {
+		if (getrusage(RUSAGE_THREAD, &own) == -1) {
+			throw("Error reading resource usage");
+		}
+		usage->user = timeval_ns(&own.ru_utime);
+		usage->system = timeval_ns(&own.ru_stime);
+		usage->voluntary = own.ru_nvcsw;
+		usage->involuntary = own.ru_nivcsw;
+
+		// Without schedstat we still have the user and system time
+		if (!read_schedstat("/proc/thread-self", usage)) {
+			usage->cpu = usage->user + usage->system;
+			usage->waiting = -1;
+		}
+
+		return true;
+	}
+
+	// /proc/<tid> exists for every thread, even if it is not listed
+	snprintf(directory, sizeof directory, "/proc/%d", (int)thread);
+	if (!read_times(directory, usage) || !read_switches(directory, usage)) {
+		return false;
+	}
+	if (!read_schedstat(directory, usage)) {
+		usage->cpu = usage->user + usage->system;
+		usage->waiting = -1;
+	}
+
+	return true;
+}
+
+void usage_subtract(CpuUsage* end, const CpuUsage* start) {
+	end->cpu -= start->cpu;
+	end->user -= start->user;
+	end->system -= start->system;
+	if (end->waiting >= 0) {
+		end->waiting -= start->waiting;
+	}
+	end->voluntary -= start->voluntary;
+	end->involuntary -= start->involuntary;
+}
+
+void usage_add(CpuUsage* into, const CpuUsage* from) {
+	into->cpu += from->cpu;
+	into->user += from->user;
+	into->system += from->system;
+	if (into->waiting >= 0 && from->waiting >= 0) {
+		into->waiting += from->waiting;
+	} else {
+		into->waiting = -1;
+	}
+	into->voluntary += from->voluntary;
+	into->involuntary += from->involuntary;
+}
+
+void usage_divide(CpuUsage* usage, double divisor) {
+	usage->cpu /= divisor;
+	usage->user /= divisor;
+	usage->system /= divisor;
+	if (usage->waiting >= 0) {
+		usage->waiting /= divisor;
+	}
+	usage->voluntary /= divisor;
+	usage->involuntary /= divisor;
+}
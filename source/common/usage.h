@@ -0,0 +1,49 @@
+#ifndef IPC_BENCH_USAGE_H
+#define IPC_BENCH_USAGE_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+/******************** DEFINITIONS ********************/
+
+// What a thread spent, in nanoseconds and context switches
+typedef struct CpuUsage {
+	// Time on a CPU, from schedstat if the kernel keeps it
+	double cpu;
+
+	// The same split into user space and the kernel, which is only as precise
+	// as the clock tick (usually 10 ms) for threads other than the caller
+	double user;
+	double system;
+
+	// Time spent runnable, waiting for a CPU (-1 = unknown)
+	double waiting;
+
+	// Switches because the thread blocked or was preempted
+	double voluntary;
+	double involuntary;
+
+} CpuUsage;
+
+/******************** INTERFACE ********************/
+
+/**
+ * Reads the usage of a thread since it started.
+ *
+ * The calling thread is read with getrusage(), other threads from /proc,
+ * which works for threads of other processes of the same user as well.
+ *
+ * \param thread The thread to read, 0 for the calling one.
+ * \param usage Where to store the usage.
+ * \return Whether the thread could be read (it may have exited).
+ */
+bool usage_read(pid_t thread, CpuUsage* usage);
+
+// Turns the usage at the end into the usage since the start
+void usage_subtract(CpuUsage* end, const CpuUsage* start);
+
+void usage_add(CpuUsage* into, const CpuUsage* from);
+
+void usage_divide(CpuUsage* usage, double divisor);
+
+#endif /* IPC_BENCH_USAGE_H */
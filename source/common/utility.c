@@ -1,9 +1,12 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/ipc.h>
 #include <sys/time.h>
 #include <time.h>
+#include <unistd.h>
 #include <assert.h>
+#include <errno.h>
 
 #define __USE_GNU
 #include <pthread.h>
@@ -29,6 +32,37 @@ void warn(const char* message) {
 	fprintf(stderr, "\033[33mWarning\033[0m: %s\n", message);
 }
 
+void write_all(int descriptor, const void* buffer, int size) {
+	ssize_t written;
+
+	while (size > 0) {
+		if ((written = write(descriptor, buffer, size)) == -1) {
+			// Non-blocking descriptors (--busy) are polled
+			if (errno == EAGAIN || errno == EINTR) continue;
+			throw("Error writing message");
+		}
+		buffer = (const char*)buffer + written;
+		size -= written;
+	}
+}
+
+void read_all(int descriptor, void* buffer, int size) {
+	ssize_t bytes;
+
+	// Stream-oriented descriptors may return part of a message
+	while (size > 0) {
+		if ((bytes = read(descriptor, buffer, size)) == -1) {
+			if (errno == EAGAIN || errno == EINTR) continue;
+			throw("Error reading message");
+		}
+		if (bytes == 0) {
+			terminate("Peer closed the connection in the middle of a message\n");
+		}
+		buffer = (char*)buffer + bytes;
+		size -= bytes;
+	}
+}
+
 int generate_key(const char* path) {
 	// Generate a random key from the given file path
 	// (inode etc.) plus the arbitrary character
@@ -63,18 +97,45 @@ int timeval_to_milliseconds(const struct timeval* time) {
 	return milliseconds;
 }
 
+void executable_directory(char* path, size_t size) {
+	char* slash;
+	ssize_t length;
+
+	if ((length = readlink("/proc/self/exe", path, size - 1)) == -1) {
+		throw("Error locating the executable");
+	}
+	path[length] = '\0';
+
+	if ((slash = strrchr(path, '/')) != NULL) {
+		*slash = '\0';
+	}
+}
+
+bool cpu_allowed(int cpu) {
+	cpu_set_t cpuset;
+
+	if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+	if (sched_getaffinity(0, sizeof cpuset, &cpuset) == -1) {
+		throw("Error retrieving CPU affinity");
+	}
+
+	return CPU_ISSET(cpu, &cpuset);
+}
+
 void pin_thread(int where) {
-	// Doesn't work on OS X right now
-	// int j;
-	// cpu_set_t cpuset;
-	// pthread_t thread;
-	// thread = pthread_self();
-	// CPU_ZERO(&cpuset);
-	// CPU_SET(where, &cpuset);
-	// pthread_setaffinity_np(thread, sizeof(cpu_set_t), &cpuset);
-	// int s = pthread_getaffinity_np(thread, sizeof(cpu_set_t), &cpuset);
-	// if (s != 0) {
-	// 	fprintf(stderr, "error: pthread_getaffinity_np");
-	// 	exit(-1);
-	// }
+	cpu_set_t cpuset;
+
+	// Leave placement to the scheduler
+	if (where < 0) return;
+	if (where >= CPU_SETSIZE) {
+		terminate("CPU number is out of range\n");
+	}
+
+	CPU_ZERO(&cpuset);
+	CPU_SET(where, &cpuset);
+
+	// Returns the error instead of setting errno
+	if ((errno = pthread_setaffinity_np(pthread_self(), sizeof cpuset, &cpuset))) {
+		throw("Error pinning thread to CPU");
+	}
 }
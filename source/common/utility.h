@@ -6,9 +6,13 @@
 #endif /* DEBUG */
 
 #include <stdbool.h>
+#include <stddef.h>
 
 /******************** DEFINITIONS ********************/
 
+// Size of a cache line, for padding data shared between processes
+#define CACHE_LINE 64
+
 struct timeval;
 
 /******************** INTERFACE ********************/
@@ -52,6 +56,12 @@ void print_error(const char* message);
  */
 void warn(const char* message);
 
+// Writes the whole buffer, retrying partial and interrupted writes
+void write_all(int descriptor, const void* buffer, int size);
+
+// Reads exactly size bytes, terminates if the peer closes the descriptor
+void read_all(int descriptor, void* buffer, int size);
+
 int generate_key(const char* path);
 
 void nsleep(int nanoseconds);
@@ -59,6 +69,20 @@ void nsleep(int nanoseconds);
 int current_milliseconds();
 int timeval_to_milliseconds(const struct timeval* time);
 
+// Writes the directory containing the running executable to path
+void executable_directory(char* path, size_t size);
+
+// Checks if the calling thread may run on the logical CPU
+bool cpu_allowed(int cpu);
+
+/**
+ * Pins the calling thread to a single CPU.
+ *
+ * The affinity is inherited by threads and processes created afterwards and
+ * survives exec(). Terminates if the CPU does not exist or is not allowed.
+ *
+ * \param where The logical CPU, or a negative value to not pin at all.
+ */
 void pin_thread(int where);
 
 #endif /* IPC_BENCH_UTILITY_H */
@@ -0,0 +1,141 @@
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+
+// Needs struct timespec
+#include <linux/errqueue.h>
+
+#include "common/arguments.h"
+#include "common/stream.h"
+#include "common/utility.h"
+#include "common/zerocopy.h"
+
+bool parse_zerocopy(Arguments *args, int argc, char *argv[]) {
+	if (!check_flag("zerocopy", argc, argv)) return false;
+
+	if (args->mode != MODE_PINGPONG || check_flag("uring", argc, argv) ||
+			check_flag("sqpoll", argc, argv) || check_flag("epoll", argc, argv)) {
+		terminate("--zerocopy only supports plain --mode pingpong\n");
+	}
+
+	name_variant(args, "-zerocopy");
+
+	return true;
+}
+
+void zerocopy_setup(ZeroCopy *zerocopy, int socket, bool enabled) {
+	const int yes = 1;
+
+	zerocopy->socket = socket;
+	zerocopy->enabled = enabled;
+	zerocopy->sent = 0;
+	zerocopy->completed = 0;
+	zerocopy->copied = 0;
+	zerocopy->calls = 0;
+
+	if (!enabled) return;
+
+	if (setsockopt(socket, SOL_SOCKET, SO_ZEROCOPY, &yes, sizeof yes) == -1) {
+		// AF_UNIX sockets, for one
+		if (errno == EOPNOTSUPP) {
+			terminate("The socket does not support MSG_ZEROCOPY, only TCP does\n");
+		}
+		throw("Error enabling zero-copy sends");
+	}
+}
+
+// Returns false if the error queue was empty
+static bool reap_notification(ZeroCopy *zerocopy) {
+	char control[CMSG_SPACE(sizeof(struct sock_extended_err))];
+	struct sock_extended_err *error;
+	struct msghdr header;
+	struct cmsghdr *message;
+
+	memset(&header, 0, sizeof header);
+	header.msg_control = control;
+	header.msg_controllen = sizeof control;
+
+	++zerocopy->calls;
+	if (recvmsg(zerocopy->socket, &header, MSG_ERRQUEUE | MSG_DONTWAIT) == -1) {
+		if (errno == EAGAIN || errno == EWOULDBLOCK) return false;
+		throw("Error reading the error queue");
+	}
+
+	for (message = CMSG_FIRSTHDR(&header); message != NULL;
+			 message = CMSG_NXTHDR(&header, message)) {
+		error = (struct sock_extended_err *)CMSG_DATA(message);
+		if (error->ee_origin != SO_EE_ORIGIN_ZEROCOPY) continue;
+
+		// One notification covers the range of sends ee_info to ee_data
+		zerocopy->completed += error->ee_data - error->ee_info + 1;
+		if (error->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+			zerocopy->copied += error->ee_data - error->ee_info + 1;
+		}
+	}
+
+	return true;
+}
+
+void zerocopy_reap(ZeroCopy *zerocopy, bool wait) {
+	struct pollfd descriptor = {zerocopy->socket, 0, 0};
+
+	while (zerocopy->completed != zerocopy->sent) {
+		if (reap_notification(zerocopy)) continue;
+		if (!wait) return;
+
+		// A non-empty error queue is signaled as POLLERR, which needs no event
+		++zerocopy->calls;
+		if (poll(&descriptor, 1, -1) == -1 && errno != EINTR) {
+			throw("Error waiting for zero-copy completions");
+		}
+	}
+}
+
+int zerocopy_send(ZeroCopy *zerocopy, const void *buffer, int size) {
+	const int flags = zerocopy->enabled ? MSG_ZEROCOPY : 0;
+	ssize_t bytes;
+
+	// Stream sockets may take a message in parts
+	while (size > 0) {
+		++zerocopy->calls;
+		if ((bytes = send(zerocopy->socket, buffer, size, flags)) == -1) {
+			if (errno == ENOBUFS && zerocopy->enabled) {
+				// Without pending notifications, reaping cannot free anything
+				if (zerocopy->completed == zerocopy->sent) {
+					terminate("Cannot pin the message for a zero-copy send, raise "
+										"net.core.optmem_max or the locked memory limit\n");
+				}
+				// Too many notifications pending on the socket's option memory
+				zerocopy_reap(zerocopy, true);
+				continue;
+			}
+			if (errno == EAGAIN) continue;
+			return -1;
+		}
+
+		// Every send() that sent anything is completed by its own number
+		if (zerocopy->enabled) ++zerocopy->sent;
+		buffer = (const char *)buffer + bytes;
+		size -= bytes;
+	}
+
+	if (zerocopy->enabled) {
+		zerocopy_reap(zerocopy, false);
+	}
+
+	return 0;
+}
+
+void zerocopy_finish(ZeroCopy *zerocopy) {
+	if (zerocopy->enabled) {
+		zerocopy_reap(zerocopy, true);
+	}
+}
+
+double zerocopy_copied(const ZeroCopy *zerocopy) {
+	if (!zerocopy->enabled || zerocopy->completed == 0) return -1;
+
+	return zerocopy->copied / (double)zerocopy->completed;
+}
@@ -0,0 +1,61 @@
+#ifndef IPC_BENCH_ZEROCOPY_H
+#define IPC_BENCH_ZEROCOPY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct Arguments;
+
+/******************** DEFINITIONS ********************/
+
+// Sends of a stream socket with MSG_ZEROCOPY (Linux 4.14), whose pages the
+// kernel pins instead of copying. A buffer may only be written again once
+// the kernel reported on the error queue that it is done with the send.
+typedef struct ZeroCopy {
+	int socket;
+	bool enabled;
+
+	// Sends issued and those the kernel reported complete
+	uint32_t sent;
+	uint32_t completed;
+
+	// Completed sends whose data the kernel copied after all (e.g. on
+	// loopback, where the receiver cannot keep the sender's pages)
+	uint32_t copied;
+
+	// System calls for sending and reaping completions
+	long calls;
+} ZeroCopy;
+
+/******************** INTERFACE ********************/
+
+// Whether --zerocopy was given, which names the results after the zero-copy
+// variant of the transport (only plain ping-pong supports it)
+bool parse_zerocopy(struct Arguments *args, int argc, char *argv[]);
+
+// Enables MSG_ZEROCOPY on the socket, or prepares plain sends
+void zerocopy_setup(ZeroCopy *zerocopy, int socket, bool enabled);
+
+/**
+ * Sends a whole message.
+ *
+ * Without zero-copy this is a plain send() (in parts, if the socket takes
+ * only some of the message). With it, the message is sent with MSG_ZEROCOPY
+ * the same way and the completions already available are reaped. Exits if
+ * the kernel cannot pin the message while no send is left to complete.
+ *
+ * \return 0 on success, -1 on error (with errno set).
+ */
+int zerocopy_send(ZeroCopy *zerocopy, const void *buffer, int size);
+
+// Reaps completions from the error queue, waiting until all sends completed
+// if asked to
+void zerocopy_reap(ZeroCopy *zerocopy, bool wait);
+
+// Waits for outstanding sends, after which the buffers may be freed
+void zerocopy_finish(ZeroCopy *zerocopy);
+
+// The fraction of completed sends the kernel copied, -1 without zero-copy
+double zerocopy_copied(const ZeroCopy *zerocopy);
+
+#endif /* IPC_BENCH_ZEROCOPY_H */
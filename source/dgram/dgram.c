@@ -0,0 +1,387 @@
+#define _GNU_SOURCE
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "common/common.h"
+#include "common/results.h"
+#include "common/sockets.h"
+#include "common/stream.h"
+
+#define SERVER 0
+#define CLIENT 1
+
+// sendmmsg() and recvmmsg() take at most UIO_MAXIOV messages per call
+#define MAX_BATCH 1024
+
+// The largest UDP payload, which a whole batch must fit into with --gso
+#define MAX_UDP_PAYLOAD 65507
+
+// About what the kernel charges a socket buffer for a datagram beyond its
+// payload, so that the buffers hold a whole batch
+#define DATAGRAM_OVERHEAD 1024
+
+typedef struct Endpoint {
+	int socket;
+	int size;
+	// Messages per round trip
+	int batch;
+	// Whether a batch is sent as one UDP GSO datagram and received coalesced
+	bool gso;
+
+	// One slot of the message size per message of a batch
+	char* buffer;
+	struct iovec* vectors;
+	struct mmsghdr* headers;
+
+	// System calls, and the receiving ones with the messages they returned
+	long calls;
+	long receives;
+	long received;
+} Endpoint;
+
+void setup_endpoint(Endpoint* endpoint, int socket, int batch, bool gso) {
+	int message;
+
+	endpoint->socket = socket;
+	endpoint->batch = batch;
+	endpoint->gso = gso;
+	endpoint->calls = 0;
+	endpoint->receives = 0;
+	endpoint->received = 0;
+
+	endpoint->buffer = malloc(batch * endpoint->size);
+	endpoint->vectors = calloc(batch, sizeof *endpoint->vectors);
+	endpoint->headers = calloc(batch, sizeof *endpoint->headers);
+	memset(endpoint->buffer, '*', batch * endpoint->size);
+
+	for (message = 0; message < batch; ++message) {
+		endpoint->vectors[message].iov_base =
+				endpoint->buffer + message * endpoint->size;
+		endpoint->vectors[message].iov_len = endpoint->size;
+		endpoint->headers[message].msg_hdr.msg_iov = &endpoint->vectors[message];
+		endpoint->headers[message].msg_hdr.msg_iovlen = 1;
+	}
+}
+
+void destroy_endpoint(Endpoint* endpoint) {
+	free(endpoint->buffer);
+	free(endpoint->vectors);
+	free(endpoint->headers);
+	close(endpoint->socket);
+}
+
+// The kernel cuts the datagram into segments of the message size
+void send_segmented(Endpoint* endpoint, int count) {
+	char control[CMSG_SPACE(sizeof(uint16_t))];
+	struct iovec vector = {endpoint->buffer, count * endpoint->size};
+	struct msghdr header;
+	struct cmsghdr* message;
+
+	memset(&header, 0, sizeof header);
+	memset(control, 0, sizeof control);
+	header.msg_iov = &vector;
+	header.msg_iovlen = 1;
+	header.msg_control = control;
+	header.msg_controllen = sizeof control;
+
+	message = CMSG_FIRSTHDR(&header);
+	message->cmsg_level = SOL_UDP;
+	message->cmsg_type = UDP_SEGMENT;
+	message->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+	*(uint16_t*)CMSG_DATA(message) = endpoint->size;
+
+	++endpoint->calls;
+	if (sendmsg(endpoint->socket, &header, 0) == -1) {
+		throw("Error sending segmented datagram");
+	}
+}
+
+void send_batch(Endpoint* endpoint, int count) {
+	int sent;
+	int result;
+
+	if (endpoint->gso) {
+		send_segmented(endpoint, count);
+		return;
+	}
+
+	// Blocking sockets may still send only part of the batch
+	for (sent = 0; sent < count; sent += result) {
+		// clang-format off
+		result = sendmmsg(endpoint->socket,
+											endpoint->headers + sent, count - sent, 0);
+		// clang-format on
+		++endpoint->calls;
+		if (result == -1) {
+			throw("Error sending datagrams");
+		}
+	}
+}
+
+// Returns the messages of one coalesced (GRO) datagram
+int receive_coalesced(Endpoint* endpoint, int count) {
+	ssize_t bytes;
+
+	bytes = recv(endpoint->socket, endpoint->buffer, count * endpoint->size, 0);
+	if (bytes <= 0) {
+		return bytes;
+	}
+
+	return (bytes + endpoint->size - 1) / endpoint->size;
+}
+
+void receive_batch(Endpoint* endpoint, int count) {
+	int received;
+	int result;
+
+	for (received = 0; received < count; received += result) {
+		if (endpoint->gso) {
+			result = receive_coalesced(endpoint, count - received);
+		} else {
+			// Blocks for the first datagram only, then takes what is queued
+			// clang-format off
+			result = recvmmsg(endpoint->socket, endpoint->headers + received,
+												count - received, MSG_WAITFORONE, NULL);
+			// clang-format on
+		}
+
+		++endpoint->calls;
+		if (result == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			terminate("No datagram arrived in time, use a smaller --batch\n");
+		} else if (result == -1) {
+			throw("Error receiving datagrams");
+		} else if (result == 0) {
+			terminate("Peer closed the socket\n");
+		}
+
+		++endpoint->receives;
+		endpoint->received += result;
+	}
+}
+
+void client_communicate(Endpoint* endpoint, struct Arguments* args) {
+	int message;
+	int count;
+
+	for (message = total_messages(args); message > 0; message -= count) {
+		count = (message < endpoint->batch) ? message : endpoint->batch;
+		receive_batch(endpoint, count);
+		send_batch(endpoint, count);
+	}
+}
+
+void server_communicate(Endpoint* endpoint,
+												 struct Arguments* args,
+												 pid_t client) {
+	const int total = total_messages(args);
+	struct Benchmarks bench;
+	Results results;
+	bench_t latency;
+	int message;
+	int count;
+	int index;
+
+	setup_benchmarks(&bench);
+	benchmarks_count_peer(&bench, client);
+
+	for (message = total; message > 0; message -= count) {
+		count = (message < endpoint->batch) ? message : endpoint->batch;
+		bench.single_start = now();
+
+		send_batch(endpoint, count);
+		receive_batch(endpoint, count);
+
+		// Every message of the batch took the whole round trip
+		latency = now() - bench.single_start;
+		for (index = 0; index < count; ++index) {
+			benchmark_sample(&bench, latency);
+		}
+	}
+
+	summarize(&bench, args, &results);
+	results.syscalls = endpoint->calls / (double)total;
+	results.per_receive = endpoint->received / (double)endpoint->receives;
+	print_results(&results, args);
+}
+
+// Makes the socket buffers hold a whole batch in flight, beyond the
+// system-wide maximum if we may
+void set_datagram_buffers(int socket, int bytes) {
+	if (bytes <= socket_buffer_size(socket, RECEIVE)) {
+		return;
+	}
+
+	// clang-format off
+	if (setsockopt(socket, SOL_SOCKET, SO_RCVBUFFORCE, &bytes, sizeof bytes) ||
+			setsockopt(socket, SOL_SOCKET, SO_SNDBUFFORCE, &bytes, sizeof bytes)) {
+		// Capped at net.core.rmem_max and wmem_max
+		setsockopt(socket, SOL_SOCKET, SO_RCVBUF, &bytes, sizeof bytes);
+		setsockopt(socket, SOL_SOCKET, SO_SNDBUF, &bytes, sizeof bytes);
+	}
+	// clang-format on
+}
+
+#ifdef DGRAM_UNIX
+
+void create_sockets(int sockets[2], bool gso) {
+	if (gso) {
+		terminate("--gso is only supported over UDP\n");
+	}
+
+	// Connected to each other, and the sender blocks instead of dropping
+	if (socketpair(AF_UNIX, SOCK_DGRAM, 0, sockets) == -1) {
+		throw("Error creating socket pair");
+	}
+}
+
+#else
+
+int bind_loopback(void) {
+	struct sockaddr_in address;
+	int socket_descriptor;
+
+	if ((socket_descriptor = socket(AF_INET, SOCK_DGRAM, 0)) == -1) {
+		throw("Error opening socket");
+	}
+
+	memset(&address, 0, sizeof address);
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	// Any free port
+	address.sin_port = 0;
+
+	// clang-format off
+	if (bind(socket_descriptor,
+					 (struct sockaddr*)&address, sizeof address) == -1) {
+		throw("Error binding socket to address");
+	}
+	// clang-format on
+
+	return socket_descriptor;
+}
+
+void connect_to(int socket_descriptor, int peer) {
+	struct sockaddr_in address;
+	socklen_t length = sizeof address;
+
+	if (getsockname(peer, (struct sockaddr*)&address, &length) == -1) {
+		throw("Error getting socket address");
+	}
+
+	// Only datagrams from the peer are received, and send needs no address
+	// clang-format off
+	if (connect(socket_descriptor,
+							(struct sockaddr*)&address, length) == -1) {
+		throw("Error connecting socket");
+	}
+	// clang-format on
+}
+
+void create_sockets(int sockets[2], bool gso) {
+	const int enable = 1;
+	int index;
+
+	sockets[SERVER] = bind_loopback();
+	sockets[CLIENT] = bind_loopback();
+	connect_to(sockets[SERVER], sockets[CLIENT]);
+	connect_to(sockets[CLIENT], sockets[SERVER]);
+
+	// GSO batches reach the peer in one piece, instead of segmented again
+	for (index = 0; gso && index < 2; ++index) {
+		// clang-format off
+		if (setsockopt(sockets[index], SOL_UDP, UDP_GRO,
+									 &enable, sizeof enable) == -1) {
+			throw("Error enabling UDP GRO");
+		}
+		// clang-format on
+	}
+}
+
+#endif
+
+void communicate(int sockets[2], struct Arguments* args, int batch, bool gso) {
+	Endpoint endpoint;
+	pid_t pid;
+
+	endpoint.size = args->size;
+
+	// Both sockets exist before the fork, so nothing needs to wait for the
+	// other side to be ready
+	if ((pid = fork()) == -1) {
+		throw("Error forking process");
+	}
+
+	if (pid == (pid_t)0) {
+		close(sockets[SERVER]);
+		setup_endpoint(&endpoint, sockets[CLIENT], batch, gso);
+		pin_thread(args->client_cpu);
+		client_communicate(&endpoint, args);
+	} else {
+		close(sockets[CLIENT]);
+		setup_endpoint(&endpoint, sockets[SERVER], batch, gso);
+		pin_thread(args->server_cpu);
+		server_communicate(&endpoint, args, pid);
+		waitpid(pid, NULL, 0);
+	}
+
+	destroy_endpoint(&endpoint);
+}
+
+// Bidirectional with datagrams, --batch=<n> messages per round trip:
+// 		server --> client
+//         \<------/
+int main(int argc, char* argv[]) {
+	struct Arguments args;
+	int sockets[2];
+	int batch = 1;
+	bool gso;
+	int index;
+
+	parse_arguments(&args, argc, argv);
+	gso = check_flag("gso", argc, argv);
+
+	if (option_value("batch", argc, argv) != NULL) {
+		batch = atoi(option_value("batch", argc, argv));
+		if (batch < 1 || batch > MAX_BATCH) {
+			terminate("Invalid batch, use 1 to 1024 messages per round trip\n");
+		}
+	}
+
+	if (args.mode != MODE_PINGPONG) {
+		terminate("Datagrams only support --mode pingpong\n");
+	}
+	if (args.size < 1) {
+		terminate("Invalid size, datagrams need at least one byte\n");
+	}
+	if (gso && (long)batch * args.size > MAX_UDP_PAYLOAD) {
+		terminate("A batch must fit into one datagram with --gso\n");
+	}
+
+	create_sockets(sockets, gso);
+
+	for (index = 0; index < 2; ++index) {
+		// clang-format off
+		set_datagram_buffers(sockets[index],
+												 2 * batch * (args.size + DATAGRAM_OVERHEAD));
+		// clang-format on
+		set_socket_both_timeouts(sockets[index], LOSS_TIMEOUT, 0);
+	}
+
+	if (gso) {
+		name_variant(&args, "-gso");
+	}
+
+	communicate(sockets, &args, batch, gso);
+
+	return EXIT_SUCCESS;
+}
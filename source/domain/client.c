@@ -1,4 +1,5 @@
 #include <fcntl.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -7,6 +8,10 @@
 
 #include "common/common.h"
 #include "common/sockets.h"
+#include "common/stream.h"
+#include "common/uring.h"
+#include "common/zerocopy.h"
+#include "domain/shards.h"
 
 #define SOCKET_PATH "/tmp/ipc_bench_socket"
 
@@ -15,10 +20,20 @@ void cleanup(int connection, void* buffer) {
 	free(buffer);
 }
 
-void communicate(int connection, struct Arguments* args, int busy_waiting) {
+void communicate(int connection,
+								 struct Arguments* args,
+								 int busy_waiting,
+								 bool zerocopy) {
 	void* buffer = malloc(args->size);
+	// Zero-copy sends must not be overwritten by the next message
+	void* reply = zerocopy ? malloc(args->size) : buffer;
+	ZeroCopy sends;
+	int message;
 
-	for (; args->count > 0; --args->count) {
+	zerocopy_setup(&sends, connection, zerocopy);
+	memset(reply, '*', args->size);
+
+	for (message = total_messages(args); message > 0; --message) {
 		if (receive(connection, buffer, args->size, busy_waiting) == -1) {
 			throw("Error receiving on client-side");
 		}
@@ -26,15 +41,26 @@ void communicate(int connection, struct Arguments* args, int busy_waiting) {
 		// Dummy operation
 		memset(buffer, '*', args->size);
 
-		if (send(connection, buffer, args->size, 0) == -1) {
+		if (zerocopy_send(&sends, reply, args->size) == -1) {
 			throw("Error sending on client-side");
 		}
 	}
 
+	zerocopy_finish(&sends);
+	if (reply != buffer) free(reply);
 	cleanup(connection, buffer);
 }
 
-void setup_socket(int connection, int busy_waiting) {
+void stream_messages(int connection, struct Arguments* args) {
+	Descriptors descriptors = {connection, connection};
+	Channel channel;
+
+	descriptor_channel(&channel, &descriptors);
+	stream_client(&channel, args);
+	cleanup(connection, NULL);
+}
+
+void setup_socket(int connection, const char* path, int busy_waiting) {
 	int return_code;
 
 	// The main datastructure for a UNIX-domain socket.
@@ -64,7 +90,7 @@ void setup_socket(int connection, int busy_waiting) {
 	// Set the family of the address struct
 	address.sun_family = AF_UNIX;
 	// Copy in the path
-	strcpy(address.sun_path, SOCKET_PATH);
+	strcpy(address.sun_path, path);
 
 	// Connect the socket to an address.
 	// Arguments:
@@ -85,13 +111,10 @@ void setup_socket(int connection, int busy_waiting) {
 	}
 }
 
-int create_connection(int busy_waiting) {
+int create_connection(const char* path, int busy_waiting) {
 	// The connection socket (file descriptor) that we will return
 	int connection;
 
-	// Wait until the server is listening on the socket
-	client_once(WAIT);
-
 	// Get a new socket from the OS
 	// Arguments:
 	// 1. The family of the socket (AF_UNIX for UNIX-domain sockets)
@@ -105,11 +128,63 @@ int create_connection(int busy_waiting) {
 		throw("Error opening socket on client-side");
 	}
 
-	setup_socket(connection, busy_waiting);
+	setup_socket(connection, path, busy_waiting);
 
 	return connection;
 }
 
+// One connection of the epoll server
+typedef struct Shard {
+	pthread_t thread;
+	int index;
+	int workers;
+	struct Arguments* args;
+	int busy_waiting;
+} Shard;
+
+void* shard_client(void* argument) {
+	Shard* shard = (Shard*)argument;
+	char path[sizeof(((struct sockaddr_un*)0)->sun_path)];
+	int connection;
+
+	// Spread the clients over the CPUs following --client-cpu
+	if (shard->args->client_cpu >= 0) {
+		// clang-format off
+		pin_thread((shard->args->client_cpu + shard->index) %
+							 sysconf(_SC_NPROCESSORS_ONLN));
+		// clang-format on
+	}
+
+	// Client i belongs to worker i % workers
+	shard_path(path, sizeof path, shard->index % shard->workers);
+	connection = create_connection(path, shard->busy_waiting);
+	communicate(connection, shard->args, shard->busy_waiting, false);
+
+	return NULL;
+}
+
+void connect_shards(struct Arguments* args, int busy_waiting, Shards* shards) {
+	Shard clients[shards->clients];
+	int index;
+
+	for (index = 0; index < shards->clients; ++index) {
+		clients[index].index = index;
+		clients[index].workers = shards->workers;
+		clients[index].args = args;
+		clients[index].busy_waiting = busy_waiting;
+		// clang-format off
+		if (pthread_create(
+					&clients[index].thread, NULL, shard_client, &clients[index])) {
+			throw("Error creating client thread");
+		}
+		// clang-format on
+	}
+
+	for (index = 0; index < shards->clients; ++index) {
+		pthread_join(clients[index].thread, NULL);
+	}
+}
+
 int main(int argc, char* argv[]) {
 	// File descriptor for the socket over which
 	// the communciation will happen with the client
@@ -119,14 +194,40 @@ int main(int argc, char* argv[]) {
 	// do busy-waiting and non-blocking calls
 	int busy_waiting;
 
+	// Connections and worker threads of the epoll server
+	Shards shards;
+
 	// For command-line arguments
 	struct Arguments args;
 
+	// Whether to send with MSG_ZEROCOPY
+	bool zerocopy;
+
 	busy_waiting = check_flag("busy", argc, argv);
 	parse_arguments(&args, argc, argv);
+	zerocopy = parse_zerocopy(&args, argc, argv);
+
+	// Wait until the server is listening on the socket
+	client_once(WAIT);
 
-	connection = create_connection(busy_waiting);
-	communicate(connection, &args, busy_waiting);
+	if (check_flag("epoll", argc, argv)) {
+		parse_shards(&shards, argc, argv);
+		connect_shards(&args, busy_waiting, &shards);
+		return EXIT_SUCCESS;
+	}
+
+	connection = create_connection(SOCKET_PATH, busy_waiting);
+	if (check_flag("uring", argc, argv) || check_flag("sqpoll", argc, argv)) {
+		// clang-format off
+		uring_client(connection, connection, &args,
+								 check_flag("sqpoll", argc, argv));
+		// clang-format on
+		cleanup(connection, NULL);
+	} else if (args.mode == MODE_PINGPONG) {
+		communicate(connection, &args, busy_waiting, zerocopy);
+	} else {
+		stream_messages(connection, &args);
+	}
 
 	return EXIT_SUCCESS;
 }
@@ -0,0 +1,368 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "common/common.h"
+#include "common/results.h"
+#include "common/sockets.h"
+#include "common/stream.h"
+#include "domain/epoll-server.h"
+
+// Events one epoll_wait() returns at most
+#define MAX_EVENTS 64
+
+typedef struct Connection {
+	int socket;
+	void* buffer;
+	// Bytes of the current message sent and received so far
+	int sent;
+	int received;
+	// Round trips left
+	int messages;
+	Benchmarks bench;
+	// The phase of the benchmark the worker knows about
+	int phase;
+} Connection;
+
+typedef struct Worker {
+	pthread_t thread;
+	int index;
+	int listener;
+	int epoll;
+	// The connections of this worker, and how many are accepted and done
+	Connection* connections;
+	int expected;
+	int accepted;
+	int finished;
+	// The CPU usage of the worker from its first connection measuring to its
+	// last one done, which the connections share
+	Benchmarks usage;
+	int measuring;
+	int measured;
+	Arguments* args;
+	int busy_waiting;
+} Worker;
+
+static void listen_on(Worker* worker, int backlog) {
+	struct sockaddr_un address;
+
+	if ((worker->listener = socket(AF_UNIX, SOCK_STREAM, 0)) == -1) {
+		throw("Error opening socket on server-side");
+	}
+
+	address.sun_family = AF_UNIX;
+	shard_path(address.sun_path, sizeof address.sun_path, worker->index);
+	remove(address.sun_path);
+
+	// clang-format off
+	if (bind(worker->listener,
+					 (struct sockaddr*)&address,
+					 SUN_LEN(&address)) == -1) {
+		throw("Error binding socket to address");
+	}
+	// clang-format on
+
+	if (listen(worker->listener, backlog) == -1) {
+		throw("Could not start listening on socket");
+	}
+
+	// Accepted sockets are non-blocking, as edge-triggered epoll requires
+	if (set_io_flag(worker->listener, O_NONBLOCK) == -1) {
+		throw("Error setting socket to non-blocking on server-side");
+	}
+}
+
+static void watch(Worker* worker, int socket, void* data) {
+	struct epoll_event event;
+
+	event.events = EPOLLIN | EPOLLOUT | EPOLLET;
+	event.data.ptr = data;
+
+	if (epoll_ctl(worker->epoll, EPOLL_CTL_ADD, socket, &event) == -1) {
+		throw("Error adding socket to epoll");
+	}
+}
+
+// Sends the rest of the current message, until the socket is full
+static void flush(Connection* connection, int size) {
+	char* buffer = connection->buffer;
+	ssize_t amount;
+
+	while (connection->sent < size) {
+		// clang-format off
+		amount = send(connection->socket,
+									buffer + connection->sent,
+									size - connection->sent,
+									MSG_NOSIGNAL);
+		// clang-format on
+		if (amount == -1) {
+			if (errno == EAGAIN) return;
+			throw("Error sending on server-side");
+		}
+		connection->sent += amount;
+	}
+}
+
+// Follows the phase of a connection's benchmark after a sample
+static void track_phase(Worker* worker, Connection* connection) {
+	const int phase = connection->bench.phase;
+
+	if (phase == connection->phase) return;
+
+	if (connection->phase == PHASE_WARMUP && worker->measuring++ == 0) {
+		benchmarks_start(&worker->usage);
+	}
+	if (phase == PHASE_DONE && ++worker->measured == worker->expected) {
+		benchmarks_stop(&worker->usage);
+	}
+
+	connection->phase = phase;
+}
+
+static void start_message(Connection* connection, int size) {
+	connection->bench.single_start = now();
+	connection->sent = 0;
+	flush(connection, size);
+}
+
+static void finish(Worker* worker, Connection* connection) {
+	epoll_ctl(worker->epoll, EPOLL_CTL_DEL, connection->socket, NULL);
+	close(connection->socket);
+	connection->socket = -1;
+	++worker->finished;
+}
+
+static void accept_all(Worker* worker) {
+	Connection* connection;
+	int socket;
+
+	while (worker->accepted < worker->expected) {
+		socket = accept4(worker->listener, NULL, NULL, SOCK_NONBLOCK);
+		if (socket == -1) {
+			if (errno == EAGAIN) return;
+			throw("Error accepting connection");
+		}
+
+		set_socket_both_buffer_sizes(socket);
+
+		connection = &worker->connections[worker->accepted++];
+		connection->socket = socket;
+		connection->received = 0;
+		connection->messages = total_messages(worker->args);
+		setup_benchmarks(&connection->bench);
+		connection->phase = PHASE_WARMUP;
+		track_phase(worker, connection);
+
+		watch(worker, socket, connection);
+		start_message(connection, worker->args->size);
+	}
+}
+
+// Reads until the socket is empty, as edge-triggered epoll requires
+static void drain(Worker* worker, Connection* connection) {
+	const int size = worker->args->size;
+	char* buffer = connection->buffer;
+	ssize_t amount;
+
+	while (connection->socket != -1) {
+		// clang-format off
+		amount = recv(connection->socket,
+									buffer + connection->received,
+									size - connection->received,
+									0);
+		// clang-format on
+		if (amount == -1) {
+			if (errno == EAGAIN) return;
+			throw("Error receiving on server-side");
+		}
+		if (amount == 0) {
+			terminate("Client closed its connection early\n");
+		}
+
+		if ((connection->received += amount) < size) continue;
+
+		// The echo is complete
+		benchmark(&connection->bench);
+		track_phase(worker, connection);
+		connection->received = 0;
+		if (--connection->messages == 0) {
+			finish(worker, connection);
+		} else {
+			start_message(connection, size);
+		}
+	}
+}
+
+static void* serve_shard(void* argument) {
+	Worker* worker = (Worker*)argument;
+	const int timeout = worker->busy_waiting ? 0 : -1;
+	struct epoll_event events[MAX_EVENTS];
+	Connection* connection;
+	int count, index;
+
+	if ((worker->epoll = epoll_create1(0)) == -1) {
+		throw("Error creating epoll instance");
+	}
+
+	// The listener is the only entry without a connection
+	watch(worker, worker->listener, NULL);
+
+	while (worker->finished < worker->expected) {
+		count = epoll_wait(worker->epoll, events, MAX_EVENTS, timeout);
+		if (count == -1) {
+			if (errno == EINTR) continue;
+			throw("Error waiting for events");
+		}
+
+		for (index = 0; index < count; ++index) {
+			if ((connection = events[index].data.ptr) == NULL) {
+				accept_all(worker);
+				continue;
+			}
+			if (connection->socket == -1) continue;
+			if (events[index].events & EPOLLOUT) {
+				flush(connection, worker->args->size);
+			}
+			if (events[index].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+				drain(worker, connection);
+			}
+		}
+	}
+
+	// In case a connection never finished measuring
+	if (worker->measuring > 0) {
+		benchmarks_stop(&worker->usage);
+	}
+	close(worker->epoll);
+
+	return NULL;
+}
+
+static void* start_worker(void* argument) {
+	Worker* worker = (Worker*)argument;
+
+	// Spread the workers over the CPUs following --server-cpu
+	if (worker->args->server_cpu >= 0) {
+		// clang-format off
+		pin_thread((worker->args->server_cpu + worker->index) %
+							 sysconf(_SC_NPROCESSORS_ONLN));
+		// clang-format on
+	}
+
+	return serve_shard(worker);
+}
+
+// Prints the results of every connection and of all of them together
+static void report(Connection* connections,
+									 const Shards* shards,
+									 Worker* workers,
+									 Arguments* args) {
+	bench_t start = UINT64_MAX, end = 0;
+	Arguments all_args = *args;
+	Benchmarks* bench;
+	Benchmarks all;
+	Results results;
+	int index;
+
+	memset(&all, 0, sizeof all);
+	all.minimum = UINT64_MAX;
+	all.phase = PHASE_DONE;
+	perf_clear(&all.perf[PERF_SELF]);
+	perf_clear(&all.perf[PERF_PEER]);
+
+	// A connection is charged the CPU time of its worker while it was
+	// measuring, which overlaps with the other connections of the worker
+	for (all_args.client = 0; all_args.client < args->clients; ++all_args.client) {
+		bench = &connections[all_args.client].bench;
+		evaluate(bench, &all_args);
+		benchmarks_merge_samples(&all, bench);
+		if (bench->total_start < start) start = bench->total_start;
+		if (bench->total_end > end) end = bench->total_end;
+	}
+
+	// Every worker once
+	for (index = 0; index < shards->workers; ++index) {
+		benchmarks_merge_usage(&all, &workers[index].usage);
+	}
+
+	// The latencies of all connections, and the throughput from the first
+	// one measuring until the last one is done
+	all_args.client = -1;
+	all_args.count *= args->clients;
+	summarize(&all, &all_args, &results);
+
+	results.total_time = end - start;
+	results.message_rate = all_args.count / (results.total_time / 1e9);
+	results.byte_rate = results.message_rate * all_args.size;
+
+	print_results(&results, &all_args);
+}
+
+void serve_epoll(const Shards* shards, Arguments* args, int busy_waiting) {
+	Connection* connections;
+	Worker* workers;
+	char path[sizeof(((struct sockaddr_un*)0)->sun_path)];
+	int index, first = 0;
+
+	if (args->mode != MODE_PINGPONG) {
+		terminate("--epoll only supports --mode pingpong\n");
+	}
+
+	args->clients = shards->clients;
+	connections = calloc(shards->clients, sizeof *connections);
+	workers = calloc(shards->workers, sizeof *workers);
+
+	// Worker i serves clients i, i + workers, ..., stored contiguously
+	for (index = 0; index < shards->workers; ++index) {
+		workers[index].index = index;
+		workers[index].connections = &connections[first];
+		workers[index].expected = (shards->clients - index - 1) / shards->workers + 1;
+		workers[index].args = args;
+		workers[index].busy_waiting = busy_waiting;
+		first += workers[index].expected;
+		listen_on(&workers[index], workers[index].expected);
+	}
+	for (index = 0; index < shards->clients; ++index) {
+		connections[index].buffer = malloc(args->size);
+		memset(connections[index].buffer, '*', args->size);
+	}
+
+	// Notify the client that it can connect to the sockets now
+	server_once(NOTIFY);
+
+	for (index = 0; index < shards->workers; ++index) {
+		// clang-format off
+		if (pthread_create(
+					&workers[index].thread, NULL, start_worker, &workers[index])) {
+			throw("Error creating worker thread");
+		}
+		// clang-format on
+	}
+	for (index = 0; index < shards->workers; ++index) {
+		pthread_join(workers[index].thread, NULL);
+	}
+
+	report(connections, shards, workers, args);
+
+	for (index = 0; index < shards->workers; ++index) {
+		close(workers[index].listener);
+		shard_path(path, sizeof path, index);
+		if (remove(path) == -1) {
+			throw("Error removing domain socket");
+		}
+	}
+	for (index = 0; index < shards->clients; ++index) {
+		free(connections[index].buffer);
+	}
+	free(connections);
+	free(workers);
+}
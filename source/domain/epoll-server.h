@@ -0,0 +1,25 @@
+#ifndef IPC_BENCH_DOMAIN_EPOLL_SERVER_H
+#define IPC_BENCH_DOMAIN_EPOLL_SERVER_H
+
+#include "domain/shards.h"
+
+struct Arguments;
+
+/******************** INTERFACE ********************/
+
+/**
+ * Serves many ping-pong connections with edge-triggered epoll.
+ *
+ * Every worker thread listens on its own path and multiplexes the
+ * connections it accepts on one epoll set, timing each round trip per
+ * connection. Prints the results of every connection and their aggregate.
+ *
+ * \param shards The number of connections and workers.
+ * \param args The parsed arguments.
+ * \param busy_waiting Whether to poll epoll instead of blocking in it.
+ */
+void serve_epoll(const Shards* shards,
+								 struct Arguments* args,
+								 int busy_waiting);
+
+#endif /* IPC_BENCH_DOMAIN_EPOLL_SERVER_H */
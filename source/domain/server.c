@@ -6,7 +6,12 @@
 #include <unistd.h>
 
 #include "common/common.h"
+#include "common/results.h"
 #include "common/sockets.h"
+#include "common/stream.h"
+#include "common/uring.h"
+#include "common/zerocopy.h"
+#include "domain/epoll-server.h"
 
 #define SOCKET_PATH "/tmp/ipc_bench_socket"
 
@@ -18,34 +23,62 @@ void cleanup(int connection, void* buffer) {
 	}
 }
 
-void communicate(int connection, struct Arguments* args, int busy_waiting) {
+void communicate(int connection,
+								 struct Arguments* args,
+								 int busy_waiting,
+								 bool zerocopy) {
+	const int total = total_messages(args);
 	struct Benchmarks bench;
+	Results results;
+	ZeroCopy sends;
 	int message;
+	int calls;
+	long receives = 0;
 	void* buffer;
+	void* reply;
 
+	zerocopy_setup(&sends, connection, zerocopy);
 	buffer = malloc(args->size);
+	// The kernel reads a zero-copy send until it completes, so the reply
+	// must not overwrite it
+	reply = zerocopy ? malloc(args->size) : buffer;
 	setup_benchmarks(&bench);
 
-	for (message = 0; message < args->count; ++message) {
+	for (message = total; message > 0; --message) {
 		bench.single_start = now();
 
-		if (send(connection, buffer, args->size, 0) < args->size) {
+		if (zerocopy_send(&sends, buffer, args->size) == -1) {
 			throw("Error sending on server-side");
 		}
 
-		memset(buffer, '*', args->size);
+		memset(reply, '*', args->size);
 
-		if (receive(connection, buffer, args->size, busy_waiting) == -1) {
+		if ((calls = receive(connection, reply, args->size, busy_waiting)) == -1) {
 			throw("Error receiving on server-side");
 		}
+		receives += calls;
 
 		benchmark(&bench);
 	}
 
-	evaluate(&bench, args);
+	summarize(&bench, args, &results);
+	results.syscalls = (sends.calls + receives) / (double)total;
+	zerocopy_finish(&sends);
+	results.copied = zerocopy_copied(&sends);
+	print_results(&results, args);
+	if (reply != buffer) free(reply);
 	cleanup(connection, buffer);
 }
 
+void stream_messages(int connection, struct Arguments* args) {
+	Descriptors descriptors = {connection, connection};
+	Channel channel;
+
+	descriptor_channel(&channel, &descriptors);
+	stream_server(&channel, args);
+	cleanup(connection, NULL);
+}
+
 void setup_socket(int socket_descriptor) {
 	int return_code;
 
@@ -163,16 +196,39 @@ int main(int argc, char* argv[]) {
 	// Flag to determine if we want busy-waiting
 	int busy_waiting;
 
+	// Connections and worker threads of the epoll server
+	Shards shards;
+
 	// For command-line arguments
 	struct Arguments args;
 
+	// Whether to send with MSG_ZEROCOPY
+	bool zerocopy;
+
 	busy_waiting = check_flag("busy", argc, argv);
 	parse_arguments(&args, argc, argv);
+	zerocopy = parse_zerocopy(&args, argc, argv);
+
+	if (check_flag("epoll", argc, argv)) {
+		parse_shards(&shards, argc, argv);
+		serve_epoll(&shards, &args, busy_waiting);
+		return EXIT_SUCCESS;
+	}
 
 	socket_descriptor = create_socket();
 	connection = accept_connection(socket_descriptor, busy_waiting);
 
-	communicate(connection, &args, busy_waiting);
+	if (check_flag("uring", argc, argv) || check_flag("sqpoll", argc, argv)) {
+		// clang-format off
+		uring_server(connection, connection, &args,
+								 check_flag("sqpoll", argc, argv));
+		// clang-format on
+		cleanup(connection, NULL);
+	} else if (args.mode == MODE_PINGPONG) {
+		communicate(connection, &args, busy_waiting, zerocopy);
+	} else {
+		stream_messages(connection, &args);
+	}
 
 	return EXIT_SUCCESS;
 }
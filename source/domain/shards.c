@@ -0,0 +1,36 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common/arguments.h"
+#include "common/utility.h"
+#include "domain/shards.h"
+
+#define SHARD_PATH "/tmp/ipc_bench_socket-%d"
+
+static int parse_positive(const char* value) {
+	char* end;
+	long number;
+
+	if (value == NULL) return 1;
+
+	number = strtol(value, &end, 10);
+	if (end == value || *end != '\0' || number <= 0) {
+		terminate("Invalid --clients or --workers, use a positive number\n");
+	}
+
+	return number;
+}
+
+void parse_shards(Shards* shards, int argc, char* argv[]) {
+	shards->clients = parse_positive(option_value("clients", argc, argv));
+	shards->workers = parse_positive(option_value("workers", argc, argv));
+
+	// A worker without a client would wait forever
+	if (shards->workers > shards->clients) {
+		terminate("Use at most as many workers as clients\n");
+	}
+}
+
+void shard_path(char* path, size_t size, int worker) {
+	snprintf(path, size, SHARD_PATH, worker);
+}
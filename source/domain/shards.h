@@ -0,0 +1,26 @@
+#ifndef IPC_BENCH_DOMAIN_SHARDS_H
+#define IPC_BENCH_DOMAIN_SHARDS_H
+
+#include <stddef.h>
+
+/******************** DEFINITIONS ********************/
+
+// With --epoll, the server runs a worker thread per listening socket and
+// client i connects to the listener of worker i % workers. AF_UNIX has no
+// SO_REUSEPORT, so every shard gets a path of its own.
+typedef struct Shards {
+	// Connections the client opens, each from a thread of its own
+	int clients;
+	// Worker threads of the server, each with a listener and an epoll set
+	int workers;
+} Shards;
+
+/******************** INTERFACE ********************/
+
+// Reads --clients=<n> and --workers=<n> (both default to one)
+void parse_shards(Shards* shards, int argc, char* argv[]);
+
+// The path of the listener of a worker
+void shard_path(char* path, size_t size, int worker);
+
+#endif /* IPC_BENCH_DOMAIN_SHARDS_H */
@@ -43,26 +43,30 @@ void eventfd_wait(int descriptor, uint64_t wanted) {
 }
 
 void client_communicate(int descriptor, struct Arguments* args) {
-	for (; args->count > 0; --args->count) {
+	int message;
+	for (message = total_messages(args); message > 0; --message) {
 		eventfd_notify(descriptor, SERVER_TOKEN);
 		eventfd_wait(descriptor, CLIENT_TOKEN);
 	}
 }
 
 
-void server_communicate(int descriptor, struct Arguments* args) {
+void server_communicate(int descriptor,
+												 struct Arguments* args,
+												 pid_t client) {
 	struct Benchmarks bench;
 	int message;
 
 	setup_benchmarks(&bench);
+	benchmarks_count_peer(&bench, client);
 
-	for (message = 0; message < args->count; ++message) {
-		// bench.single_start = now();
+	for (message = total_messages(args); message > 0; --message) {
+		bench.single_start = now();
 
 		eventfd_wait(descriptor, SERVER_TOKEN);
 		eventfd_notify(descriptor, CLIENT_TOKEN);
 
-		// benchmark(&bench);
+		benchmark(&bench);
 	}
 
 	// The message size is always one (it's just a signal)
@@ -82,10 +86,12 @@ void communicate(int descriptor, struct Arguments* args) {
 
 	// fork() returns 0 for the child process
 	if (pid == (pid_t)0) {
+		pin_thread(args->client_cpu);
 		client_communicate(descriptor, args);
 		close(descriptor);
 	} else {
-		server_communicate(descriptor, args);
+		pin_thread(args->server_cpu);
+		server_communicate(descriptor, args, pid);
 	}
 }
 
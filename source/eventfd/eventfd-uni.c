@@ -22,11 +22,14 @@ void client_communicate(int descriptor, struct Arguments* args) {
 }
 
 
-void server_communicate(int descriptor, struct Arguments* args) {
+void server_communicate(int descriptor,
+												 struct Arguments* args,
+												 pid_t client) {
 	int message;
 	struct Benchmarks bench;
 
 	setup_benchmarks(&bench);
+	benchmarks_count_peer(&bench, client);
 
 	for (message = 0; message < args->count; ++message) {
 		// A read from an eventfd returns the 8-byte integer
@@ -62,10 +65,12 @@ void communicate(int descriptor, struct Arguments* args) {
 
 	// fork() returns 0 for the child process
 	if (pid == (pid_t)0) {
+		pin_thread(args->client_cpu);
 		client_communicate(descriptor, args);
 		close(descriptor);
 	} else {
-		server_communicate(descriptor, args);
+		pin_thread(args->server_cpu);
+		server_communicate(descriptor, args, pid);
 	}
 }
 
@@ -80,6 +85,7 @@ int main(int argc, char* argv[]) {
 
 	struct Arguments args;
 	parse_arguments(&args, argc, argv);
+	reject_warmup(&args);
 
 	// Create a new eventfd object and get the corresponding
 	// file descriptor. The first argument is the initial value,
@@ -5,8 +5,10 @@
 #include <unistd.h>
 
 #include "common/common.h"
+#include "common/stream.h"
 
 #define FIFO_PATH "/tmp/ipc_bench_fifo"
+#define ACK_FIFO_PATH "/tmp/ipc_bench_fifo_ack"
 
 void cleanup(FILE *stream, void *buffer) {
 	free(buffer);
@@ -16,12 +18,13 @@ void cleanup(FILE *stream, void *buffer) {
 void communicate(FILE *stream,
 								 struct Arguments *args,
 								 struct sigaction *signal_action) {
+	int message;
 	void *buffer = malloc(args->size);
 
 	// Server can go
 	notify_server();
 
-	for (; args->count > 0; --args->count) {
+	for (message = total_messages(args); message > 0; --message) {
 		wait_for_signal(signal_action);
 
 		if (fread(buffer, args->size, 1, stream) == 0) {
@@ -34,6 +37,22 @@ void communicate(FILE *stream,
 	cleanup(stream, buffer);
 }
 
+void stream_messages(FILE *stream, struct Arguments *args) {
+	Descriptors descriptors;
+	Channel channel;
+
+	if ((descriptors.ack = open(ACK_FIFO_PATH, O_WRONLY)) == -1) {
+		throw("Error opening acknowledgement FIFO on client-side");
+	}
+	descriptors.data = fileno(stream);
+
+	descriptor_channel(&channel, &descriptors);
+	stream_client(&channel, args);
+
+	close(descriptors.ack);
+	cleanup(stream, NULL);
+}
+
 FILE *open_fifo(struct sigaction *signal_action) {
 	FILE *stream;
 
@@ -63,7 +82,11 @@ int main(int argc, char *argv[]) {
 	setup_client_signals(&signal_action);
 	stream = open_fifo(&signal_action);
 
-	communicate(stream, &args, &signal_action);
+	if (args.mode == MODE_PINGPONG) {
+		communicate(stream, &args, &signal_action);
+	} else {
+		stream_messages(stream, &args);
+	}
 
 	return EXIT_SUCCESS;
 }
@@ -1,3 +1,4 @@
+#include <errno.h>
 #include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -6,8 +7,10 @@
 #include <unistd.h>
 
 #include "common/common.h"
+#include "common/stream.h"
 
 #define FIFO_PATH "/tmp/ipc_bench_fifo"
+#define ACK_FIFO_PATH "/tmp/ipc_bench_fifo_ack"
 
 void cleanup(FILE* stream, void* buffer) {
 	free(buffer);
@@ -29,7 +32,7 @@ void communicate(FILE* stream,
 
 	wait_for_signal(signal_action);
 
-	for (message = 0; message < args->count; ++message) {
+	for (message = total_messages(args); message > 0; --message) {
 		bench.single_start = now();
 
 		if (fwrite(buffer, args->size, 1, stream) == 0) {
@@ -48,7 +51,27 @@ void communicate(FILE* stream,
 	cleanup(stream, buffer);
 }
 
-FILE* open_fifo() {
+void stream_messages(FILE* stream, struct Arguments* args) {
+	Descriptors descriptors;
+	Channel channel;
+
+	// Opened after the data FIFO on both sides, so neither open() blocks forever
+	if ((descriptors.ack = open(ACK_FIFO_PATH, O_RDONLY)) == -1) {
+		throw("Error opening acknowledgement FIFO on server side");
+	}
+	descriptors.data = fileno(stream);
+
+	descriptor_channel(&channel, &descriptors);
+	stream_server(&channel, args);
+
+	close(descriptors.ack);
+	if (remove(ACK_FIFO_PATH) == -1) {
+		throw("Error removing acknowledgement FIFO");
+	}
+	cleanup(stream, NULL);
+}
+
+FILE* open_fifo(struct Arguments* args) {
 	FILE* stream;
 
 	// Just in case it already exists
@@ -64,6 +87,12 @@ FILE* open_fifo() {
 		throw("Error creating FIFO");
 	}
 
+	// The stream modes acknowledge messages over a second FIFO
+	if (args->mode != MODE_PINGPONG && mkfifo(ACK_FIFO_PATH, 0666) == -1 &&
+			errno != EEXIST) {
+		throw("Error creating acknowledgement FIFO");
+	}
+
 	// Tell the client the fifo now exists and
 	// can be opened from the read end
 	notify_client();
@@ -89,9 +118,13 @@ int main(int argc, char* argv[]) {
 	parse_arguments(&args, argc, argv);
 
 	setup_server_signals(&signal_action);
-	stream = open_fifo();
+	stream = open_fifo(&args);
 
-	communicate(stream, &args, &signal_action);
+	if (args.mode == MODE_PINGPONG) {
+		communicate(stream, &args, &signal_action);
+	} else {
+		stream_messages(stream, &args);
+	}
 
 	return EXIT_SUCCESS;
 }
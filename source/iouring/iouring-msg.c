@@ -0,0 +1,244 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "common/common.h"
+#include "common/results.h"
+#include "common/stream.h"
+#include "common/uring.h"
+
+#define SERVER 0
+#define CLIENT 1
+
+// Entries of the submission queues, a side has at most one request in flight
+#define MESSAGE_ENTRIES 4
+
+// Completions the rings hold before the kernel keeps them on an overflow
+// list, which is slower (stream mode may send many before an ack)
+#define MESSAGE_COMPLETIONS 4096
+
+// The user data of our own MSG_RING requests, which only complete in our
+// ring if they fail. Completions posted by the peer carry its payload.
+#define OWN_REQUEST UINT64_MAX
+
+// A ring per side, each receiving the messages for its owner
+typedef struct MessageRings {
+	Uring rings[2];
+	// Whether messages carry a 64-bit value (--payload)
+	bool payload;
+	struct Arguments* args;
+	// The client's thread or process, once it runs
+	volatile pid_t client;
+} MessageRings;
+
+// Posts a completion with the value into the other ring, and waits for
+// completions in our own ring with the same system call
+void ring_notify(Uring* from, Uring* to, uint64_t value, unsigned wait) {
+	struct io_uring_sqe* entry = uring_entry(from);
+
+	entry->opcode = IORING_OP_MSG_RING;
+	entry->fd = to->descriptor;
+	entry->addr = IORING_MSG_DATA;
+	// Becomes the user data of the completion in the other ring
+	entry->off = value;
+	entry->flags = IOSQE_CQE_SKIP_SUCCESS;
+	entry->user_data = OWN_REQUEST;
+
+	uring_submit(from, wait);
+}
+
+uint64_t ring_wait(Uring* ring) {
+	uint64_t value;
+	int result;
+
+	result = uring_complete(ring, &value);
+	if (value == OWN_REQUEST) {
+		errno = -result;
+		throw("Error posting to the other ring");
+	}
+
+	return value;
+}
+
+void message_send(void* context, void* buffer, int size) {
+	MessageRings* rings = (MessageRings*)context;
+	uint64_t value = 0;
+
+	if (rings->payload) {
+		memcpy(&value, buffer, sizeof value);
+	}
+
+	ring_notify(&rings->rings[SERVER], &rings->rings[CLIENT], value, 0);
+}
+
+void message_receive(void* context, void* buffer, int size) {
+	MessageRings* rings = (MessageRings*)context;
+	uint64_t value = ring_wait(&rings->rings[CLIENT]);
+
+	if (rings->payload) {
+		memcpy(buffer, &value, sizeof value);
+	}
+}
+
+void message_acknowledge(void* context) {
+	MessageRings* rings = (MessageRings*)context;
+
+	ring_notify(&rings->rings[CLIENT], &rings->rings[SERVER], 0, 0);
+}
+
+void message_wait_for_ack(void* context) {
+	ring_wait(&((MessageRings*)context)->rings[SERVER]);
+}
+
+void message_channel(Channel* channel, MessageRings* rings) {
+	channel->context = rings;
+	channel->send = message_send;
+	channel->receive = message_receive;
+	channel->acknowledge = message_acknowledge;
+	channel->wait_for_ack = message_wait_for_ack;
+	channel->peer = 0;
+}
+
+void client_communicate(MessageRings* rings) {
+	Uring* own = &rings->rings[CLIENT];
+	Uring* server = &rings->rings[SERVER];
+	struct Arguments* args = rings->args;
+	Channel channel;
+	uint64_t value;
+	int message;
+
+	if (args->mode != MODE_PINGPONG) {
+		message_channel(&channel, rings);
+		stream_client(&channel, args);
+		return;
+	}
+
+	for (message = total_messages(args); message > 0; --message) {
+		value = ring_wait(own);
+		// The echo goes out together with waiting for the next message
+		ring_notify(own, server, value, message > 1 ? 1 : 0);
+	}
+}
+
+void server_communicate(MessageRings* rings) {
+	Uring* own = &rings->rings[SERVER];
+	Uring* client = &rings->rings[CLIENT];
+	struct Arguments* args = rings->args;
+	const int total = total_messages(args);
+	struct Benchmarks bench;
+	Results results;
+	Channel channel;
+	uint64_t value;
+	int message;
+
+	// A client thread publishes itself once it runs
+	while (rings->client == 0)
+		;
+
+	if (args->mode != MODE_PINGPONG) {
+		message_channel(&channel, rings);
+		channel.peer = rings->client;
+		stream_server(&channel, args);
+		return;
+	}
+
+	setup_benchmarks(&bench);
+	benchmarks_count_peer(&bench, rings->client);
+
+	for (message = 1; message <= total; ++message) {
+		bench.single_start = now();
+
+		// Sends and waits for the echo with one system call
+		ring_notify(own, client, rings->payload ? message : 0, 1);
+		value = ring_wait(own);
+
+		if (rings->payload && value != (uint64_t)message) {
+			terminate("Received the wrong payload\n");
+		}
+
+		benchmark(&bench);
+	}
+
+	summarize(&bench, args, &results);
+	results.syscalls = own->enters / (double)total;
+	print_results(&results, args);
+}
+
+void* client_thread(void* argument) {
+	MessageRings* rings = (MessageRings*)argument;
+
+	rings->client = gettid();
+	pin_thread(rings->args->client_cpu);
+	client_communicate(rings);
+
+	return NULL;
+}
+
+void communicate(MessageRings* rings, bool threads) {
+	pthread_t thread;
+	pid_t pid;
+
+	if (threads) {
+		if (pthread_create(&thread, NULL, client_thread, rings)) {
+			throw("Error creating client thread");
+		}
+		pin_thread(rings->args->server_cpu);
+		server_communicate(rings);
+		pthread_join(thread, NULL);
+		return;
+	}
+
+	// The rings survive fork(), every process submits to its own
+	if ((pid = fork()) == -1) {
+		throw("Error forking process");
+	}
+
+	if (pid == (pid_t)0) {
+		client_thread(rings);
+	} else {
+		rings->client = pid;
+		pin_thread(rings->args->server_cpu);
+		server_communicate(rings);
+		waitpid(pid, NULL, 0);
+	}
+}
+
+int main(int argc, char* argv[]) {
+	struct Arguments args;
+	MessageRings rings;
+	bool threads;
+
+	parse_arguments(&args, argc, argv);
+	threads = check_flag("threads", argc, argv);
+	rings.payload = check_flag("payload", argc, argv);
+	rings.args = &args;
+	rings.client = 0;
+
+	// Instead of an eventfd to read, every side waits for completions in
+	// its own ring, which the other side posts with IORING_OP_MSG_RING
+	// (Linux 5.18), optionally carrying a 64-bit value in the user data
+	// clang-format off
+	uring_create(&rings.rings[SERVER],
+							 MESSAGE_ENTRIES, MESSAGE_COMPLETIONS, false);
+	uring_create(&rings.rings[CLIENT],
+							 MESSAGE_ENTRIES, MESSAGE_COMPLETIONS, false);
+	// clang-format on
+
+	// The message is the payload, or just a notification
+	args.size = rings.payload ? sizeof(uint64_t) : 1;
+
+	communicate(&rings, threads);
+
+	uring_destroy(&rings.rings[SERVER]);
+	uring_destroy(&rings.rings[CLIENT]);
+
+	return EXIT_SUCCESS;
+}
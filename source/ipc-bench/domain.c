@@ -0,0 +1,84 @@
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "common/arguments.h"
+#include "common/sockets.h"
+#include "common/utility.h"
+#include "ipc-bench/transport.h"
+
+// A connected pair of UNIX-domain stream sockets per client, no path
+// to clean up
+typedef struct Sockets {
+	int server;
+	int client;
+} Sockets;
+
+static size_t domain_shared_size(const struct Arguments *args) {
+	return sizeof(Sockets) * args->clients;
+}
+
+static void domain_setup(void *shared, const struct Arguments *args) {
+	Sockets *sockets = (Sockets *)shared;
+	int pair[2];
+	int client;
+
+	for (client = 0; client < args->clients; ++client) {
+		if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == -1) {
+			throw("Error creating socket pair");
+		}
+
+		set_socket_both_buffer_sizes(pair[0]);
+		set_socket_both_buffer_sizes(pair[1]);
+
+		sockets[client].server = pair[0];
+		sockets[client].client = pair[1];
+	}
+}
+
+static void *domain_open(void *shared,
+												 Role role,
+												 int client,
+												 const struct Arguments *args) {
+	Sockets *sockets = (Sockets *)shared;
+	Endpoint *endpoint;
+
+	if (role == ROLE_CLIENT) {
+		// clang-format off
+		return endpoint_create_single(
+			sockets[client].client, sockets[client].client);
+		// clang-format on
+	}
+
+	endpoint = endpoint_create(args->clients);
+	for (client = 0; client < args->clients; ++client) {
+		endpoint->in[client] = sockets[client].server;
+		endpoint->out[client] = sockets[client].server;
+	}
+
+	return endpoint;
+}
+
+static void domain_teardown(void *shared, const struct Arguments *args) {
+	Sockets *sockets = (Sockets *)shared;
+	int client;
+
+	for (client = 0; client < args->clients; ++client) {
+		close(sockets[client].server);
+		close(sockets[client].client);
+	}
+}
+
+const Transport domain_transport = {
+		.name = "domain",
+		.pipelined = true,
+		.shared_size = domain_shared_size,
+		.setup = domain_setup,
+		.open = domain_open,
+		.send = endpoint_send,
+		.receive = endpoint_receive,
+		.receive_any = endpoint_receive_any,
+		.send_to = endpoint_send_to,
+		.publish = endpoint_publish,
+		.close = endpoint_close,
+		.teardown = domain_teardown,
+};
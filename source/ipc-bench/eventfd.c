@@ -0,0 +1,130 @@
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "common/arguments.h"
+#include "common/utility.h"
+#include "ipc-bench/transport.h"
+
+// An eventfd per direction and client. Like eventfd-bi, a message is only
+// a signal: the counter carries no payload.
+typedef struct EventFds {
+	int to_client;
+	int to_server;
+} EventFds;
+
+static size_t eventfd_shared_size(const struct Arguments *args) {
+	return sizeof(EventFds) * args->clients;
+}
+
+static int create_eventfd() {
+	int descriptor;
+
+	// A semaphore, so that every read consumes exactly one signal
+	if ((descriptor = eventfd(0, EFD_SEMAPHORE)) == -1) {
+		throw("Error creating eventfd");
+	}
+
+	return descriptor;
+}
+
+static void eventfd_setup(void *shared, const struct Arguments *args) {
+	EventFds *eventfds = (EventFds *)shared;
+	int client;
+
+	for (client = 0; client < args->clients; ++client) {
+		eventfds[client].to_client = create_eventfd();
+		eventfds[client].to_server = create_eventfd();
+	}
+}
+
+static void *eventfd_open(void *shared,
+													Role role,
+													int client,
+													const struct Arguments *args) {
+	EventFds *eventfds = (EventFds *)shared;
+	Endpoint *endpoint;
+
+	if (role == ROLE_CLIENT) {
+		// clang-format off
+		return endpoint_create_single(
+			eventfds[client].to_client, eventfds[client].to_server);
+		// clang-format on
+	}
+
+	endpoint = endpoint_create(args->clients);
+	for (client = 0; client < args->clients; ++client) {
+		endpoint->in[client] = eventfds[client].to_server;
+		endpoint->out[client] = eventfds[client].to_client;
+	}
+
+	return endpoint;
+}
+
+static void signal_eventfd(int descriptor) {
+	uint64_t value = 1;
+
+	write_all(descriptor, &value, sizeof value);
+}
+
+static void wait_eventfd(int descriptor) {
+	uint64_t value;
+
+	read_all(descriptor, &value, sizeof value);
+}
+
+static void eventfd_send(void *endpoint, void *buffer, int size) {
+	signal_eventfd(((Endpoint *)endpoint)->out[0]);
+}
+
+static void eventfd_receive(void *endpoint, void *buffer, int size) {
+	wait_eventfd(((Endpoint *)endpoint)->in[0]);
+}
+
+static int eventfd_receive_any(void *endpoint, void *buffer, int size) {
+	int peer = endpoint_ready((Endpoint *)endpoint);
+
+	wait_eventfd(((Endpoint *)endpoint)->in[peer]);
+
+	return peer;
+}
+
+static void eventfd_send_to(void *endpoint, int peer, void *buffer, int size) {
+	signal_eventfd(((Endpoint *)endpoint)->out[peer]);
+}
+
+static void eventfd_publish(void *endpoint, void *buffer, int size) {
+	Endpoint *fds = (Endpoint *)endpoint;
+	int peer;
+
+	for (peer = 0; peer < fds->peers; ++peer) {
+		signal_eventfd(fds->out[peer]);
+	}
+}
+
+static void eventfd_teardown(void *shared, const struct Arguments *args) {
+	EventFds *eventfds = (EventFds *)shared;
+	int client;
+
+	for (client = 0; client < args->clients; ++client) {
+		close(eventfds[client].to_client);
+		close(eventfds[client].to_server);
+	}
+}
+
+const Transport eventfd_transport = {
+		.name = "eventfd",
+		.pipelined = true,
+		// The message is the signal itself
+		.max_size = 1,
+		.shared_size = eventfd_shared_size,
+		.setup = eventfd_setup,
+		.open = eventfd_open,
+		.send = eventfd_send,
+		.receive = eventfd_receive,
+		.receive_any = eventfd_receive_any,
+		.send_to = eventfd_send_to,
+		.publish = eventfd_publish,
+		.close = endpoint_close,
+		.teardown = eventfd_teardown,
+};
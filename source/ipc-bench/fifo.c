@@ -0,0 +1,111 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "common/arguments.h"
+#include "common/utility.h"
+#include "ipc-bench/transport.h"
+
+#define PATH_SIZE 128
+
+// A fresh directory per run holds a request and a reply FIFO per client
+typedef struct Fifos {
+	char directory[64];
+} Fifos;
+
+static size_t fifo_shared_size(const struct Arguments *args) {
+	return sizeof(Fifos);
+}
+
+static void fifo_path(char *path, const Fifos *fifos, int client, char kind) {
+	snprintf(path, PATH_SIZE, "%s/%d%c", fifos->directory, client, kind);
+}
+
+static void fifo_setup(void *shared, const struct Arguments *args) {
+	Fifos *fifos = (Fifos *)shared;
+	char path[PATH_SIZE];
+	int client;
+
+	snprintf(fifos->directory, sizeof fifos->directory, "/tmp/ipc_bench_XXXXXX");
+	if (mkdtemp(fifos->directory) == NULL) {
+		throw("Error creating FIFO directory");
+	}
+
+	for (client = 0; client < args->clients; ++client) {
+		fifo_path(path, fifos, client, 'q');
+		if (mkfifo(path, 0600) == -1) throw("Error creating FIFO");
+		fifo_path(path, fifos, client, 'r');
+		if (mkfifo(path, 0600) == -1) throw("Error creating FIFO");
+	}
+}
+
+static int open_fifo(const Fifos *fifos, int client, char kind) {
+	char path[PATH_SIZE];
+	int descriptor;
+
+	// Opening for reading and writing does not block until the peer
+	// opens the other end (Linux only, POSIX leaves it undefined)
+	fifo_path(path, fifos, client, kind);
+	if ((descriptor = open(path, O_RDWR)) == -1) {
+		throw("Error opening FIFO");
+	}
+
+	return descriptor;
+}
+
+static void *fifo_open(void *shared,
+											 Role role,
+											 int client,
+											 const struct Arguments *args) {
+	Fifos *fifos = (Fifos *)shared;
+	Endpoint *endpoint;
+
+	if (role == ROLE_CLIENT) {
+		// clang-format off
+		return endpoint_create_single(
+			open_fifo(fifos, client, 'r'), open_fifo(fifos, client, 'q'));
+		// clang-format on
+	}
+
+	endpoint = endpoint_create(args->clients);
+	for (client = 0; client < args->clients; ++client) {
+		endpoint->in[client] = open_fifo(fifos, client, 'q');
+		endpoint->out[client] = open_fifo(fifos, client, 'r');
+	}
+
+	return endpoint;
+}
+
+static void fifo_teardown(void *shared, const struct Arguments *args) {
+	Fifos *fifos = (Fifos *)shared;
+	char path[PATH_SIZE];
+	int client;
+
+	for (client = 0; client < args->clients; ++client) {
+		fifo_path(path, fifos, client, 'q');
+		remove(path);
+		fifo_path(path, fifos, client, 'r');
+		remove(path);
+	}
+
+	if (rmdir(fifos->directory) == -1) {
+		throw("Error removing FIFO directory");
+	}
+}
+
+const Transport fifo_transport = {
+		.name = "fifo",
+		.pipelined = true,
+		.shared_size = fifo_shared_size,
+		.setup = fifo_setup,
+		.open = fifo_open,
+		.send = endpoint_send,
+		.receive = endpoint_receive,
+		.receive_any = endpoint_receive_any,
+		.send_to = endpoint_send_to,
+		.publish = endpoint_publish,
+		.close = endpoint_close_all,
+		.teardown = fifo_teardown,
+};
@@ -0,0 +1,943 @@
+#define _GNU_SOURCE
+#include <math.h>
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "common/common.h"
+#include "common/guard.h"
+#include "common/results.h"
+#include "common/stream.h"
+#include "ipc-bench/transport.h"
+
+// Most values a --sizes or --counts list may have
+#define MAX_VALUES 32
+
+// An open-loop sender spins for the last part of a gap, sleeping is not
+// precise enough
+#define SPIN_NANOSECONDS 20000
+
+// How the client role is started
+typedef enum Launch {
+	// A forked copy of the driver
+	LAUNCH_FORK,
+	// A forked and re-exec()'d driver, like the per-transport programs
+	LAUNCH_EXEC,
+	// A thread of the driver
+	LAUNCH_THREAD
+} Launch;
+
+// What a client leaves for the driver
+typedef struct ClientReport {
+	// Fan-in and open loop: the benchmarks of the client
+	Benchmarks bench;
+	// Broadcast: how long the current message took to arrive
+	alignas(CACHE_LINE) bench_t latency;
+	// The thread of the client, for the counters of --perf
+	pid_t thread;
+} ClientReport;
+
+// Where the clients of a fan-in or broadcast run report to the driver,
+// behind the shared state of the transport
+typedef struct Report {
+	// The thread of the server, for the counters of --perf
+	pid_t server;
+	// Fan-in: clients past their warmup and clients done measuring
+	atomic_int measuring;
+	atomic_int done;
+	// Broadcast: when the current message was published
+	bench_t published;
+	// Broadcast: counts the messages received by all subscribers
+	Guard received;
+	// Set once the server has measured, so that a client does not exit
+	// before the server has read its CPU usage
+	Guard measured;
+	ClientReport clients[];
+} Report;
+
+// The latencies of a broadcast run
+typedef struct Broadcast {
+	// Until the slowest and the median subscriber had a message
+	Benchmarks slowest;
+	Benchmarks median;
+	// Time the publisher spent sending a message
+	Benchmarks publish;
+} Broadcast;
+
+// The part of a fan-in run from the first client measuring to the last one
+// done, like the aggregate of the domain epoll server
+typedef struct Window {
+	bench_t start;
+	bench_t end;
+	long messages;
+} Window;
+
+// Everything a role needs
+typedef struct Run {
+	const Transport *transport;
+	Arguments args;
+	void *shared;
+	size_t shared_size;
+	int shared_file;
+	Report *report;
+	// Whether clients send requests to one server (--clients)
+	bool fan_in;
+	// Whether the server publishes to all clients (--broadcast)
+	bool broadcast;
+	// The index of a client role
+	int client;
+} Run;
+
+// The lists of values to run every transport with
+typedef struct Matrix {
+	int clients[MAX_VALUES];
+	int rates[MAX_VALUES];
+	int sizes[MAX_VALUES];
+	int counts[MAX_VALUES];
+	int client_count, rate_count, size_count, count_count;
+} Matrix;
+
+// The sender thread of an open-loop client
+typedef struct OpenLoop {
+	Run *run;
+	void *endpoint;
+	// When each request was meant to be sent
+	bench_t *intended;
+} OpenLoop;
+
+void print_driver_usage() {
+	int index;
+
+	printf(
+			"Usage: ipc-bench [--transports=<name>,...] [--sizes=<bytes>,...] "
+			"[--counts=<number>,...] [--clients=<number>,...|scale] "
+			"[--broadcast] [--rate=<msg/s>,...] [--arrivals=<fixed|poisson>] "
+			"[--launch=<fork|exec|thread>] "
+			"[<options of the transports>]\n"
+			"Runs every combination of transport, clients, size and count in one "
+			"process.\n"
+			"Transports:");
+	for (index = 0; transports[index] != NULL; ++index) {
+		printf(" %s", transports[index]->name);
+	}
+	printf("\n");
+	exit(EXIT_FAILURE);
+}
+
+int parse_arrivals(const char *value) {
+	if (value == NULL || strcmp(value, "fixed") == 0) return false;
+	if (strcmp(value, "poisson") == 0) return true;
+
+	terminate("Unknown arrivals, use one of fixed, poisson\n");
+}
+
+int parse_launch(const char *value) {
+	if (value == NULL || strcmp(value, "fork") == 0) return LAUNCH_FORK;
+	if (strcmp(value, "exec") == 0) return LAUNCH_EXEC;
+	if (strcmp(value, "thread") == 0) return LAUNCH_THREAD;
+
+	terminate("Unknown launch method, use one of fork, exec, thread\n");
+}
+
+// Parses a comma-separated list of numbers, or uses the fallback
+int parse_numbers(const char *value, int numbers[MAX_VALUES], int fallback) {
+	char *end;
+	int count = 0;
+
+	if (value == NULL) {
+		numbers[0] = fallback;
+		return 1;
+	}
+
+	while (count < MAX_VALUES) {
+		numbers[count++] = strtol(value, &end, 10);
+		if (end == value || numbers[count - 1] <= 0) {
+			terminate("Invalid list, use positive numbers like 64,4096\n");
+		}
+		if (*end != ',') break;
+		value = end + 1;
+	}
+
+	return count;
+}
+
+// Parses --clients, where scale means powers of two up to the CPU count
+int parse_clients(const char *value, int numbers[MAX_VALUES]) {
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	int count = 0;
+	int clients;
+
+	if (value == NULL || strcmp(value, "scale") != 0) {
+		return parse_numbers(value, numbers, 1);
+	}
+
+	for (clients = 1; clients < cpus && count < MAX_VALUES - 1; clients *= 2) {
+		numbers[count++] = clients;
+	}
+	numbers[count++] = cpus;
+
+	return count;
+}
+
+// Parses a comma-separated list of transports, or uses all of them
+int parse_transports(const char *value, const Transport *selected[]) {
+	char names[256];
+	char *name;
+	int count = 0;
+
+	if (value == NULL) {
+		for (; transports[count] != NULL; ++count) {
+			selected[count] = transports[count];
+		}
+		return count;
+	}
+
+	snprintf(names, sizeof names, "%s", value);
+	for (name = strtok(names, ","); name != NULL && count < MAX_VALUES;
+			 name = strtok(NULL, ",")) {
+		if ((selected[count++] = find_transport(name)) == NULL) {
+			fprintf(stderr, "Unknown transport '%s'\n", name);
+			print_driver_usage();
+		}
+	}
+
+	return count;
+}
+
+static size_t report_offset(Run *run) {
+	size_t size = run->transport->shared_size(&run->args);
+
+	return (size + CACHE_LINE - 1) & ~(size_t)(CACHE_LINE - 1);
+}
+
+static size_t shared_size(Run *run) {
+	// clang-format off
+	return report_offset(run) + sizeof(Report) +
+				 run->args.clients * sizeof(ClientReport);
+	// clang-format on
+}
+
+void map_shared(Run *run) {
+	// Outlives fork() and, through the descriptor, exec() as well
+	run->shared = mmap(NULL,
+										 run->shared_size,
+										 PROT_READ | PROT_WRITE,
+										 MAP_SHARED,
+										 run->shared_file,
+										 0);
+
+	if (run->shared == MAP_FAILED) {
+		throw("Error mapping shared state");
+	}
+
+	run->report = (Report *)((char *)run->shared + report_offset(run));
+}
+
+void create_shared(Run *run) {
+	run->shared_size = shared_size(run);
+
+	if ((run->shared_file = memfd_create("ipc-bench", 0)) == -1) {
+		throw("Error creating shared state");
+	}
+	if (ftruncate(run->shared_file, run->shared_size) == -1) {
+		throw("Error sizing shared state");
+	}
+
+	map_shared(run);
+}
+
+// A fan-in client sends requests and measures the round trips itself
+void fan_in_client(Run *run) {
+	const Transport *transport = run->transport;
+	void *buffer = malloc(run->args.size);
+	struct Benchmarks bench;
+	bool measuring, done = false;
+	void *endpoint;
+	int message;
+
+	memset(buffer, '*', run->args.size);
+	// clang-format off
+	endpoint = transport->open(
+		run->shared, ROLE_CLIENT, run->client, &run->args);
+	// clang-format on
+
+	// Say hello and wait until the server has heard from everyone
+	transport->send(endpoint, buffer, run->args.size);
+	transport->receive(endpoint, buffer, run->args.size);
+
+	setup_benchmarks(&bench);
+	benchmarks_count_peer(&bench, run->report->server);
+	if ((measuring = (bench.phase != PHASE_WARMUP))) {
+		atomic_fetch_add(&run->report->measuring, 1);
+	}
+
+	for (message = total_messages(&run->args); message > 0; --message) {
+		bench.single_start = now();
+
+		transport->send(endpoint, buffer, run->args.size);
+		transport->receive(endpoint, buffer, run->args.size);
+
+		benchmark(&bench);
+
+		// Let the server know when the measurement starts and ends
+		if (!measuring && bench.phase != PHASE_WARMUP) {
+			atomic_fetch_add(&run->report->measuring, 1);
+			measuring = true;
+		}
+		if (!done && bench.phase == PHASE_DONE) {
+			atomic_fetch_add(&run->report->done, 1);
+			done = true;
+		}
+	}
+
+	run->report->clients[run->client].bench = bench;
+
+	transport->close(endpoint);
+	free(buffer);
+}
+
+// A subscriber tells the publisher how long every message took to arrive
+void subscriber(Run *run) {
+	const Transport *transport = run->transport;
+	ClientReport *report = &run->report->clients[run->client];
+	void *buffer = malloc(run->args.size);
+	void *endpoint;
+	int message;
+
+	// clang-format off
+	endpoint = transport->open(
+		run->shared, ROLE_CLIENT, run->client, &run->args);
+	// clang-format on
+
+	// Ready to receive
+	guard_ring(&run->report->received);
+
+	for (message = total_messages(&run->args); message > 0; --message) {
+		transport->receive(endpoint, buffer, run->args.size);
+		report->latency = now() - run->report->published;
+		guard_ring(&run->report->received);
+	}
+
+	transport->close(endpoint);
+	free(buffer);
+}
+
+static int compare_latencies(const void *first, const void *second) {
+	const bench_t a = *(const bench_t *)first;
+	const bench_t b = *(const bench_t *)second;
+
+	return (a > b) - (a < b);
+}
+
+// Publishes one message at a time and waits until every subscriber has it,
+// so that no transport has to buffer (or drop) messages for slow readers
+void publisher(Run *run, Broadcast *broadcast) {
+	const Transport *transport = run->transport;
+	const int clients = run->args.clients;
+	void *buffer = malloc(run->args.size);
+	bench_t *latencies = malloc(clients * sizeof *latencies);
+	Guard *received = &run->report->received;
+	int message, expected, client;
+	void *endpoint;
+
+	memset(buffer, '*', run->args.size);
+	endpoint = transport->open(run->shared, ROLE_SERVER, 0, &run->args);
+
+	guard_wait(received, expected = clients, &run->args);
+
+	setup_benchmarks(&broadcast->slowest);
+	setup_benchmarks(&broadcast->median);
+	setup_benchmarks(&broadcast->publish);
+
+	for (message = total_messages(&run->args); message > 0; --message) {
+		run->report->published = broadcast->publish.single_start = now();
+		transport->publish(endpoint, buffer, run->args.size);
+		benchmark(&broadcast->publish);
+
+		guard_wait(received, expected += clients, &run->args);
+
+		for (client = 0; client < clients; ++client) {
+			latencies[client] = run->report->clients[client].latency;
+		}
+		qsort(latencies, clients, sizeof *latencies, compare_latencies);
+		benchmark_sample(&broadcast->slowest, latencies[clients - 1]);
+		benchmark_sample(&broadcast->median, latencies[(clients - 1) / 2]);
+	}
+
+	transport->close(endpoint);
+	free(latencies);
+	free(buffer);
+}
+
+void report_broadcast(Run *run, Broadcast *broadcast) {
+	Results results;
+
+	summarize(&broadcast->slowest, &run->args, &results);
+	results.series = "slowest";
+	print_results(&results, &run->args);
+
+	summarize(&broadcast->median, &run->args, &results);
+	results.series = "median";
+	print_results(&results, &run->args);
+
+	summarize(&broadcast->publish, &run->args, &results);
+	results.series = "publish";
+	print_results(&results, &run->args);
+}
+
+// Waits until the deadline, without using a core for long gaps
+static void wait_until(bench_t deadline) {
+	bench_t current;
+
+	while ((current = now()) < deadline) {
+		if (deadline - current > SPIN_NANOSECONDS) {
+			// Below a second, as nanosleep() wants
+			nsleep((deadline - current - SPIN_NANOSECONDS) % 1000000000);
+		}
+	}
+}
+
+// The gap until the next request: fixed, or exponentially distributed
+// for a Poisson process with the same mean
+static bench_t next_gap(const Arguments *args, unsigned short seed[3]) {
+	const double mean = 1e9 / args->rate;
+
+	if (!args->poisson) return mean;
+
+	return -log(1 - erand48(seed)) * mean;
+}
+
+// Sends requests on schedule, no matter whether replies keep up
+void *open_loop_sender(void *argument) {
+	OpenLoop *loop = (OpenLoop *)argument;
+	Run *run = loop->run;
+	void *buffer = malloc(run->args.size);
+	unsigned short seed[3] = {0x1234, 0xabcd, (unsigned short)run->args.rate};
+	bench_t intended = now();
+	int message;
+
+	// Let nanosleep() wake us up as close to the deadline as it can
+	prctl(PR_SET_TIMERSLACK, 1);
+	memset(buffer, '*', run->args.size);
+
+	for (message = 0; message < total_messages(&run->args); ++message) {
+		intended += next_gap(&run->args, seed);
+		wait_until(intended);
+
+		// The schedule does not slip when a send blocks, so a stalled
+		// server shows up in the latency of every request it delays
+		loop->intended[message] = intended;
+		run->transport->send(loop->endpoint, buffer, run->args.size);
+	}
+
+	free(buffer);
+
+	return NULL;
+}
+
+// An open-loop client measures from when a request was meant to be sent
+// until its reply arrives, to avoid coordinated omission
+void open_loop_client(Run *run) {
+	const Transport *transport = run->transport;
+	const int total = total_messages(&run->args);
+	void *buffer = malloc(run->args.size);
+	struct Benchmarks bench;
+	pthread_t sender;
+	OpenLoop loop;
+	int message;
+
+	loop.run = run;
+	loop.intended = malloc(total * sizeof *loop.intended);
+	loop.endpoint = transport->open(run->shared, ROLE_CLIENT, 0, &run->args);
+
+	// Tell the server we are ready
+	transport->send(loop.endpoint, buffer, run->args.size);
+
+	setup_benchmarks(&bench);
+	benchmarks_count_peer(&bench, run->report->server);
+	if (pthread_create(&sender, NULL, open_loop_sender, &loop) != 0) {
+		throw("Error creating sender thread");
+	}
+
+	// Replies arrive in the order of the requests
+	for (message = 0; message < total; ++message) {
+		transport->receive(loop.endpoint, buffer, run->args.size);
+		benchmark_sample(&bench, now() - loop.intended[message]);
+	}
+
+	pthread_join(sender, NULL);
+	run->report->clients[0].bench = bench;
+
+	transport->close(loop.endpoint);
+	free(loop.intended);
+	free(buffer);
+}
+
+// Answers every request of an open-loop client
+void echo_server(Run *run) {
+	const Transport *transport = run->transport;
+	void *buffer = malloc(run->args.size);
+	void *endpoint;
+	int message;
+
+	endpoint = transport->open(run->shared, ROLE_SERVER, 0, &run->args);
+
+	// Wait for the client
+	transport->receive(endpoint, buffer, run->args.size);
+
+	for (message = total_messages(&run->args); message > 0; --message) {
+		transport->receive(endpoint, buffer, run->args.size);
+		transport->send(endpoint, buffer, run->args.size);
+	}
+
+	transport->close(endpoint);
+	free(buffer);
+}
+
+void client_role(Run *run) {
+	const Transport *transport = run->transport;
+	void *buffer;
+	void *endpoint;
+	int message;
+
+	run->report->clients[run->client].thread = gettid();
+
+	if (run->args.rate > 0) {
+		open_loop_client(run);
+		return;
+	}
+	if (run->broadcast) {
+		subscriber(run);
+		return;
+	}
+	if (run->fan_in) {
+		fan_in_client(run);
+		return;
+	}
+
+	buffer = malloc(run->args.size);
+	endpoint = transport->open(run->shared, ROLE_CLIENT, 0, &run->args);
+
+	// Tell the server we are ready, an exec()'d client takes a while
+	transport->send(endpoint, buffer, run->args.size);
+
+	for (message = total_messages(&run->args); message > 0; --message) {
+		transport->receive(endpoint, buffer, run->args.size);
+		transport->send(endpoint, buffer, run->args.size);
+	}
+
+	guard_sleep(&run->report->measured, 1);
+
+	transport->close(endpoint);
+	free(buffer);
+}
+
+void server_role(Run *run) {
+	const Transport *transport = run->transport;
+	void *buffer = malloc(run->args.size);
+	struct Benchmarks bench;
+	void *endpoint;
+	int message;
+
+	memset(buffer, '*', run->args.size);
+	endpoint = transport->open(run->shared, ROLE_SERVER, 0, &run->args);
+
+	// Wait for the client
+	transport->receive(endpoint, buffer, run->args.size);
+	setup_benchmarks(&bench);
+	benchmarks_count_peer(&bench, run->report->clients[0].thread);
+
+	for (message = total_messages(&run->args); message > 0; --message) {
+		bench.single_start = now();
+
+		transport->send(endpoint, buffer, run->args.size);
+		transport->receive(endpoint, buffer, run->args.size);
+
+		benchmark(&bench);
+	}
+
+	guard_notify(&run->report->measured, 1);
+	evaluate(&bench, &run->args);
+
+	transport->close(endpoint);
+	free(buffer);
+}
+
+// Serves the requests of all clients in the order they arrive and times
+// the part of the run during which any client was measuring
+Window fan_in_server(Run *run) {
+	const Transport *transport = run->transport;
+	const int clients = run->args.clients;
+	void *buffer = malloc(run->args.size);
+	Window window = {0, 0, 0};
+	bool started = false;
+	void *endpoint;
+	long served, total;
+	int peer;
+
+	endpoint = transport->open(run->shared, ROLE_SERVER, 0, &run->args);
+
+	// Start all clients at once
+	for (peer = 0; peer < clients; ++peer) {
+		transport->receive_any(endpoint, buffer, run->args.size);
+	}
+	for (peer = 0; peer < clients; ++peer) {
+		transport->send_to(endpoint, peer, buffer, run->args.size);
+	}
+
+	total = (long)clients * total_messages(&run->args);
+	for (served = 0; served < total; ++served) {
+		peer = transport->receive_any(endpoint, buffer, run->args.size);
+		transport->send_to(endpoint, peer, buffer, run->args.size);
+
+		if (!started && atomic_load(&run->report->measuring) > 0) {
+			window.start = now();
+			window.messages = served;
+			started = true;
+		}
+		if (started && window.end == 0 &&
+				atomic_load(&run->report->done) == clients) {
+			window.end = now();
+			window.messages = served - window.messages;
+		}
+	}
+
+	// The last client may only be done after its last reply
+	if (started && window.end == 0) {
+		window.end = now();
+		window.messages = served - window.messages;
+	}
+
+	// Would be a throughput of nothing, e.g. with too few messages per client
+	if (window.messages < clients) {
+		terminate("Fan-in clients measured too few messages for a throughput\n");
+	}
+
+	transport->close(endpoint);
+	free(buffer);
+
+	return window;
+}
+
+// Prints the results of every client and of the run as a whole
+void report_fan_in(Run *run, const Window *window) {
+	bench_t duration = window->end - window->start;
+	Arguments args = run->args;
+	Benchmarks all;
+	Results results;
+
+	for (args.client = 0; args.client < args.clients; ++args.client) {
+		evaluate(&run->report->clients[args.client].bench, &args);
+	}
+
+	memset(&all, 0, sizeof all);
+	all.minimum = UINT64_MAX;
+	all.phase = PHASE_DONE;
+	perf_clear(&all.perf[PERF_SELF]);
+	perf_clear(&all.perf[PERF_PEER]);
+	for (args.client = 0; args.client < args.clients; ++args.client) {
+		benchmarks_merge(&all, &run->report->clients[args.client].bench);
+	}
+
+	// The latencies of all clients, but the throughput the server saw
+	args.client = -1;
+	args.count *= args.clients;
+	summarize(&all, &args, &results);
+
+	results.total_time = duration;
+	results.message_rate = 0;
+	if (duration > 0) {
+		results.message_rate = window->messages / (duration / 1e9);
+	}
+	results.byte_rate = results.message_rate * args.size;
+
+	print_results(&results, &args);
+}
+
+// Spreads the clients over the CPUs following --client-cpu
+static int client_cpu(const Run *run) {
+	if (run->args.client_cpu < 0) return -1;
+
+	return (run->args.client_cpu + run->client) % sysconf(_SC_NPROCESSORS_ONLN);
+}
+
+void *client_thread(void *run) {
+	pin_thread(client_cpu((Run *)run));
+	client_role((Run *)run);
+
+	return NULL;
+}
+
+void exec_client(Run *run, int argc, char *argv[]) {
+	char executable[4096];
+	char role_run[128];
+	char shared[32];
+	char *arguments[argc + 4];
+	int index;
+
+	// The client finds its run and the shared state in these options
+	// clang-format off
+	snprintf(role_run, sizeof role_run, "--role-run=%s,%d,%d,%d,%d,%.17g",
+					 run->transport->name, run->args.size, run->args.count,
+					 run->args.clients, run->client, run->args.rate);
+	// clang-format on
+	snprintf(shared, sizeof shared, "--shared=%d", run->shared_file);
+
+	executable_directory(executable, sizeof executable);
+	strncat(executable, "/ipc-bench", sizeof executable - strlen(executable) - 1);
+
+	arguments[0] = executable;
+	for (index = 1; index < argc; ++index) {
+		arguments[index] = argv[index];
+	}
+	arguments[argc] = role_run;
+	arguments[argc + 1] = shared;
+	arguments[argc + 2] = NULL;
+
+	execv(executable, arguments);
+	throw("Error starting client");
+}
+
+void run_once(Run *run, int launch, int argc, char *argv[]) {
+	const int clients = run->args.clients;
+	pthread_t threads[clients];
+	pid_t pids[clients];
+	Run roles[clients];
+	Broadcast broadcast;
+	Window window;
+	int client;
+
+	create_shared(run);
+	run->report->server = gettid();
+	run->transport->setup(run->shared, &run->args);
+
+	for (client = 0; client < clients; ++client) {
+		roles[client] = *run;
+		roles[client].client = client;
+
+		if (launch == LAUNCH_THREAD) {
+			// clang-format off
+			if (pthread_create(
+						&threads[client], NULL, client_thread, &roles[client]) != 0) {
+				throw("Error creating client thread");
+			}
+			// clang-format on
+			continue;
+		}
+
+		if ((pids[client] = fork()) == -1) {
+			throw("Error forking client");
+		}
+		if (pids[client] == 0) {
+			// The affinity mask is inherited across exec
+			pin_thread(client_cpu(&roles[client]));
+			if (launch == LAUNCH_EXEC) {
+				exec_client(&roles[client], argc, argv);
+			}
+			client_role(&roles[client]);
+			_exit(EXIT_SUCCESS);
+		}
+	}
+
+	if (run->args.rate > 0) {
+		echo_server(run);
+	} else if (run->broadcast) {
+		publisher(run, &broadcast);
+	} else if (run->fan_in) {
+		window = fan_in_server(run);
+	} else {
+		server_role(run);
+	}
+
+	for (client = 0; client < clients; ++client) {
+		if (launch == LAUNCH_THREAD) {
+			pthread_join(threads[client], NULL);
+		} else if (waitpid(pids[client], NULL, 0) == -1) {
+			throw("Error waiting for client");
+		}
+	}
+
+	// The clients have left their benchmarks in the report
+	if (run->args.rate > 0) {
+		evaluate(&run->report->clients[0].bench, &run->args);
+	} else if (run->broadcast) {
+		report_broadcast(run, &broadcast);
+	} else if (run->fan_in) {
+		report_fan_in(run, &window);
+	}
+
+	run->transport->teardown(run->shared, &run->args);
+	munmap(run->shared, run->shared_size);
+	close(run->shared_file);
+}
+
+// The entry point of an exec()'d client
+void run_client(const char *role_run, int argc, char *argv[]) {
+	char name[64];
+	Run run;
+
+	parse_arguments(&run.args, argc, argv);
+
+	// clang-format off
+	if (sscanf(role_run, "%63[^,],%d,%d,%d,%d,%lf", name,
+						 &run.args.size, &run.args.count,
+						 &run.args.clients, &run.client, &run.args.rate) != 6 ||
+			(run.transport = find_transport(name)) == NULL ||
+			option_value("shared", argc, argv) == NULL) {
+		terminate("Invalid client role\n");
+	}
+	// clang-format on
+
+	setup_warmup(&run.args);
+	run.args.poisson = parse_arrivals(option_value("arrivals", argc, argv));
+
+	// Broadcasts never exec()
+	run.broadcast = false;
+	run.fan_in = option_value("clients", argc, argv) != NULL;
+	run.shared_file = atoi(option_value("shared", argc, argv));
+	run.shared_size = shared_size(&run);
+	map_shared(&run);
+
+	client_role(&run);
+}
+
+// Runs one transport for every combination of the lists
+void run_transport(Run *run,
+									 const Arguments *args,
+									 const Matrix *matrix,
+									 int launch,
+									 int argc,
+									 char *argv[]) {
+	int client, rate, size, count;
+
+	for (client = 0; client < matrix->client_count; ++client) {
+		for (rate = 0; rate < matrix->rate_count; ++rate) {
+			for (size = 0; size < matrix->size_count; ++size) {
+				for (count = 0; count < matrix->count_count; ++count) {
+					run->args = *args;
+					run->args.clients = matrix->clients[client];
+					run->args.rate = matrix->rates[rate];
+					run->args.size = matrix->sizes[size];
+					run->args.count = matrix->counts[count];
+					// clang-format off
+					snprintf(run->args.transport, sizeof run->args.transport,
+									 "%s", run->transport->name);
+					// clang-format on
+
+					if (run->transport->max_size > 0 &&
+							run->args.size > run->transport->max_size) {
+						fprintf(stderr,
+										"Skipping %s, messages are limited to %d bytes\n",
+										run->transport->name,
+										run->transport->max_size);
+						continue;
+					}
+
+					// The warmup budget depends on the count
+					setup_warmup(&run->args);
+					run_once(run, launch, argc, argv);
+				}
+			}
+		}
+	}
+}
+
+// Tells why the transport cannot do what was asked, or returns NULL
+const char *unsupported(const Run *run, bool open_loop) {
+	if (run->broadcast && run->transport->publish == NULL) {
+		return "it cannot broadcast";
+	}
+	if (!run->broadcast && run->transport->send == NULL) {
+		return "it only broadcasts";
+	}
+	if (run->fan_in && run->transport->receive_any == NULL) {
+		return "it cannot serve several clients";
+	}
+	if (open_loop && !run->transport->pipelined) {
+		return "it cannot have several messages in flight";
+	}
+
+	return NULL;
+}
+
+int main(int argc, char *argv[]) {
+	const Transport *selected[MAX_VALUES];
+	int transport_count, transport;
+	const char *reason;
+	Matrix matrix;
+	Arguments args;
+	bool open_loop;
+	Run run;
+	int launch;
+
+	if (option_value("role-run", argc, argv) != NULL) {
+		run_client(option_value("role-run", argc, argv), argc, argv);
+		return EXIT_SUCCESS;
+	}
+
+	if (check_flag("help", argc, argv)) {
+		print_driver_usage();
+	}
+
+	parse_arguments(&args, argc, argv);
+	if (args.mode != MODE_PINGPONG) {
+		terminate("The driver only measures ping-pong, see the transports for --mode\n");
+	}
+
+	// clang-format off
+	transport_count = parse_transports(
+		option_value("transports", argc, argv), selected);
+	matrix.size_count = parse_numbers(
+		option_value("sizes", argc, argv), matrix.sizes, args.size);
+	matrix.count_count = parse_numbers(
+		option_value("counts", argc, argv), matrix.counts, args.count);
+	matrix.rate_count = parse_numbers(
+		option_value("rate", argc, argv), matrix.rates, 0);
+	matrix.client_count = parse_clients(
+		option_value("clients", argc, argv), matrix.clients);
+	// clang-format on
+	args.poisson = parse_arrivals(option_value("arrivals", argc, argv));
+	launch = parse_launch(option_value("launch", argc, argv));
+	run.broadcast = check_flag("broadcast", argc, argv);
+	run.fan_in = !run.broadcast && option_value("clients", argc, argv) != NULL;
+	open_loop = option_value("rate", argc, argv) != NULL;
+
+	// Subscribers compare their clock with the publisher's
+	if (run.broadcast && launch == LAUNCH_EXEC) {
+		terminate("--broadcast needs clients sharing the clock, use fork or thread\n");
+	}
+	if (open_loop && (run.broadcast || run.fan_in)) {
+		terminate("--rate drives a single client, leave out --clients and --broadcast\n");
+	}
+	if (run.broadcast) {
+		args.mode = MODE_BROADCAST;
+	}
+	if (open_loop) {
+		args.mode = MODE_OPEN_LOOP;
+	}
+
+	// The server role always runs in the driver itself
+	pin_thread(args.server_cpu);
+
+	for (transport = 0; transport < transport_count; ++transport) {
+		run.transport = selected[transport];
+		if ((reason = unsupported(&run, open_loop)) != NULL) {
+			fprintf(stderr, "Skipping %s, %s\n", run.transport->name, reason);
+			continue;
+		}
+
+		run_transport(&run, &args, &matrix, launch, argc, argv);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,252 @@
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/arguments.h"
+#include "common/guard.h"
+#include "common/utility.h"
+#include "ipc-bench/transport.h"
+
+// The clients enqueue their requests into one bounded multi-producer queue
+// in the style of Dmitry Vyukov's: every slot has a sequence number that
+// tells producers when it is free and the consumer when it is full, so a
+// producer only contends on the enqueue index. Replies go to a mailbox
+// per client, guarded like shm.
+typedef struct Header {
+	// Next position to claim, shared by all clients
+	alignas(CACHE_LINE) atomic_size_t enqueue;
+	// Next position to read, server only
+	alignas(CACHE_LINE) size_t dequeue;
+	// Rung after every request when the server may sleep (--wait)
+	Guard doorbell;
+} Header;
+
+typedef struct Slot {
+	atomic_size_t sequence;
+	int client;
+	alignas(16) char payload[];
+} Slot;
+
+typedef struct Mailbox {
+	Guard guard;
+	char payload[];
+} Mailbox;
+
+typedef struct MpscEndpoint {
+	Header *header;
+	char *slots;
+	char *mailboxes;
+	size_t slot_size;
+	size_t mailbox_size;
+	size_t mask;
+	// The index of a client, -1 for the server
+	int client;
+	const struct Arguments *args;
+} MpscEndpoint;
+
+static size_t round_to_line(size_t size) {
+	return (size + CACHE_LINE - 1) & ~(size_t)(CACHE_LINE - 1);
+}
+
+// Every client has at most one request in flight, so this never fills up
+static size_t queue_slots(const struct Arguments *args) {
+	size_t slots = 2;
+
+	while (slots < (size_t)args->clients) {
+		slots *= 2;
+	}
+
+	return slots;
+}
+
+static size_t slot_size(const struct Arguments *args) {
+	return round_to_line(sizeof(Slot) + args->size);
+}
+
+static size_t mailbox_size(const struct Arguments *args) {
+	return round_to_line(sizeof(Mailbox) + args->size);
+}
+
+static size_t mpsc_shared_size(const struct Arguments *args) {
+	return sizeof(Header) + queue_slots(args) * slot_size(args) +
+				 args->clients * mailbox_size(args);
+}
+
+static Slot *slot_at(MpscEndpoint *mpsc, size_t position) {
+	return (Slot *)(mpsc->slots + (position & mpsc->mask) * mpsc->slot_size);
+}
+
+static Mailbox *mailbox_of(MpscEndpoint *mpsc, int client) {
+	return (Mailbox *)(mpsc->mailboxes + client * mpsc->mailbox_size);
+}
+
+static void *mpsc_open(void *shared,
+											 Role role,
+											 int client,
+											 const struct Arguments *args) {
+	MpscEndpoint *endpoint = malloc(sizeof *endpoint);
+
+	endpoint->header = (Header *)shared;
+	endpoint->slots = (char *)shared + sizeof(Header);
+	endpoint->slot_size = slot_size(args);
+	endpoint->mask = queue_slots(args) - 1;
+	endpoint->mailboxes = endpoint->slots + queue_slots(args) * slot_size(args);
+	endpoint->mailbox_size = mailbox_size(args);
+	endpoint->client = (role == ROLE_SERVER) ? -1 : client;
+	endpoint->args = args;
+
+	return endpoint;
+}
+
+static void mpsc_setup(void *shared, const struct Arguments *args) {
+	MpscEndpoint *endpoint;
+	size_t position;
+
+	memset(shared, 0, mpsc_shared_size(args));
+
+	// A slot is free for the producer whose position equals its sequence
+	endpoint = mpsc_open(shared, ROLE_SERVER, 0, args);
+	for (position = 0; position <= endpoint->mask; ++position) {
+		atomic_init(&slot_at(endpoint, position)->sequence, position);
+	}
+	free(endpoint);
+}
+
+static void enqueue(MpscEndpoint *mpsc, void *buffer, int size) {
+	atomic_size_t *index = &mpsc->header->enqueue;
+	size_t position = atomic_load_explicit(index, memory_order_relaxed);
+	intptr_t difference;
+	Slot *slot;
+
+	for (;;) {
+		slot = slot_at(mpsc, position);
+		// clang-format off
+		difference = (intptr_t)atomic_load_explicit(
+			&slot->sequence, memory_order_acquire) - (intptr_t)position;
+		// clang-format on
+
+		if (difference == 0) {
+			// Claim the slot, a failed exchange reloads the position
+			if (atomic_compare_exchange_weak_explicit(index,
+																								&position,
+																								position + 1,
+																								memory_order_relaxed,
+																								memory_order_relaxed)) {
+				break;
+			}
+		} else {
+			// Another client got there first, or the queue is full
+			position = atomic_load_explicit(index, memory_order_relaxed);
+		}
+	}
+
+	slot->client = mpsc->client;
+	memcpy(slot->payload, buffer, size);
+	atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+
+	if (mpsc->args->wait != WAIT_SPIN) {
+		guard_ring(&mpsc->header->doorbell);
+	}
+}
+
+static int is_full(Slot *slot, size_t position) {
+	// clang-format off
+	return atomic_load_explicit(
+		&slot->sequence, memory_order_acquire) == position + 1;
+	// clang-format on
+}
+
+static void wait_for_request(MpscEndpoint *mpsc, Slot *slot, size_t position) {
+	Guard *doorbell = &mpsc->header->doorbell;
+	int spins = mpsc->args->spin_count;
+	int rung;
+
+	while (!is_full(slot, position)) {
+		if (mpsc->args->wait == WAIT_SPIN) continue;
+		if (mpsc->args->wait == WAIT_HYBRID && spins-- > 0) continue;
+
+		// Checking the slot after reading the doorbell means that we
+		// either see the request or sleep on a doorbell that has changed
+		rung = atomic_load(&doorbell->token);
+		if (is_full(slot, position)) break;
+		guard_sleep_while(doorbell, rung);
+	}
+}
+
+static int mpsc_receive_any(void *endpoint, void *buffer, int size) {
+	MpscEndpoint *mpsc = (MpscEndpoint *)endpoint;
+	const size_t position = mpsc->header->dequeue;
+	Slot *slot = slot_at(mpsc, position);
+	int client;
+
+	wait_for_request(mpsc, slot, position);
+
+	client = slot->client;
+	memcpy(buffer, slot->payload, size);
+
+	// Free the slot for the producer one lap ahead
+	// clang-format off
+	atomic_store_explicit(
+		&slot->sequence, position + mpsc->mask + 1, memory_order_release);
+	// clang-format on
+	mpsc->header->dequeue = position + 1;
+
+	return client;
+}
+
+static void mpsc_send_to(void *endpoint, int peer, void *buffer, int size) {
+	Mailbox *mailbox = mailbox_of((MpscEndpoint *)endpoint, peer);
+
+	// The client does not touch its mailbox until it has the token
+	memcpy(mailbox->payload, buffer, size);
+	guard_notify(&mailbox->guard, 'r');
+}
+
+static void mpsc_send(void *endpoint, void *buffer, int size) {
+	MpscEndpoint *mpsc = (MpscEndpoint *)endpoint;
+
+	if (mpsc->client == -1) {
+		mpsc_send_to(endpoint, 0, buffer, size);
+	} else {
+		enqueue(mpsc, buffer, size);
+	}
+}
+
+static void mpsc_receive(void *endpoint, void *buffer, int size) {
+	MpscEndpoint *mpsc = (MpscEndpoint *)endpoint;
+	Mailbox *mailbox;
+
+	if (mpsc->client == -1) {
+		mpsc_receive_any(endpoint, buffer, size);
+		return;
+	}
+
+	mailbox = mailbox_of(mpsc, mpsc->client);
+	guard_wait(&mailbox->guard, 'r', mpsc->args);
+	memcpy(buffer, mailbox->payload, size);
+
+	// The next reply only comes after our next request
+	atomic_store(&mailbox->guard.token, 0);
+}
+
+static void mpsc_close(void *endpoint) {
+	free(endpoint);
+}
+
+static void mpsc_teardown(void *shared, const struct Arguments *args) {
+}
+
+const Transport mpsc_transport = {
+		.name = "mpsc",
+		.shared_size = mpsc_shared_size,
+		.setup = mpsc_setup,
+		.open = mpsc_open,
+		.send = mpsc_send,
+		.receive = mpsc_receive,
+		.receive_any = mpsc_receive_any,
+		.send_to = mpsc_send_to,
+		.close = mpsc_close,
+		.teardown = mpsc_teardown,
+};
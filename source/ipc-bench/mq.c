@@ -0,0 +1,143 @@
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ipc.h>
+#include <sys/msg.h>
+
+#include "common/arguments.h"
+#include "common/utility.h"
+#include "ipc-bench/transport.h"
+#include "mq/mq-common.h"
+
+// Requests of all clients share one queue, so that the server takes them
+// in order of arrival, replies are told apart by their type
+typedef struct Queues {
+	int requests;
+	int replies;
+} Queues;
+
+typedef struct MqEndpoint {
+	Queues queues;
+	// The type of the messages of a client, zero for the server
+	long type;
+	// Separate buffers, so that two threads can send and receive
+	struct Message *outgoing;
+	struct Message *incoming;
+} MqEndpoint;
+
+static size_t mq_shared_size(const struct Arguments *args) {
+	return sizeof(Queues);
+}
+
+static int create_queue() {
+	int queue;
+
+	// A private queue is only known by its identifier, which is
+	// all an exec()'d client needs, and does not collide with mq
+	if ((queue = msgget(IPC_PRIVATE, IPC_CREAT | 0600)) == -1) {
+		throw("Error creating message-queue");
+	}
+
+	return queue;
+}
+
+static void mq_setup(void *shared, const struct Arguments *args) {
+	((Queues *)shared)->requests = create_queue();
+	((Queues *)shared)->replies = create_queue();
+}
+
+static void *mq_open(void *shared,
+										 Role role,
+										 int client,
+										 const struct Arguments *args) {
+	MqEndpoint *endpoint = malloc(sizeof *endpoint);
+
+	endpoint->queues = *(Queues *)shared;
+	// Message types must be positive
+	endpoint->type = (role == ROLE_SERVER) ? 0 : client + 1;
+	endpoint->outgoing = create_message((struct Arguments *)args);
+	endpoint->incoming = create_message((struct Arguments *)args);
+
+	return endpoint;
+}
+
+static void send_message(
+		int queue, MqEndpoint *mq, long type, void *buffer, int size) {
+	mq->outgoing->type = type;
+	memcpy(mq->outgoing->buffer, buffer, size);
+
+	if (msgsnd(queue, mq->outgoing, size, 0) == -1) {
+		throw("Error sending message");
+	}
+}
+
+static long receive_message(
+		int queue, MqEndpoint *mq, long type, void *buffer, int size) {
+	if (msgrcv(queue, mq->incoming, size, type, 0) < size) {
+		throw("Error receiving message");
+	}
+
+	memcpy(buffer, mq->incoming->buffer, size);
+
+	return mq->incoming->type;
+}
+
+static void mq_send(void *endpoint, void *buffer, int size) {
+	MqEndpoint *mq = (MqEndpoint *)endpoint;
+
+	if (mq->type == 0) {
+		send_message(mq->queues.replies, mq, 1, buffer, size);
+	} else {
+		send_message(mq->queues.requests, mq, mq->type, buffer, size);
+	}
+}
+
+static void mq_receive(void *endpoint, void *buffer, int size) {
+	MqEndpoint *mq = (MqEndpoint *)endpoint;
+
+	if (mq->type == 0) {
+		receive_message(mq->queues.requests, mq, 0, buffer, size);
+	} else {
+		receive_message(mq->queues.replies, mq, mq->type, buffer, size);
+	}
+}
+
+static int mq_receive_any(void *endpoint, void *buffer, int size) {
+	MqEndpoint *mq = (MqEndpoint *)endpoint;
+
+	// Type zero takes the first message, whoever sent it
+	return receive_message(mq->queues.requests, mq, 0, buffer, size) - 1;
+}
+
+static void mq_send_to(void *endpoint, int peer, void *buffer, int size) {
+	MqEndpoint *mq = (MqEndpoint *)endpoint;
+
+	send_message(mq->queues.replies, mq, peer + 1, buffer, size);
+}
+
+static void mq_close(void *endpoint) {
+	free(((MqEndpoint *)endpoint)->outgoing);
+	free(((MqEndpoint *)endpoint)->incoming);
+	free(endpoint);
+}
+
+static void mq_teardown(void *shared, const struct Arguments *args) {
+	if (msgctl(((Queues *)shared)->requests, IPC_RMID, NULL) == -1 ||
+			msgctl(((Queues *)shared)->replies, IPC_RMID, NULL) == -1) {
+		throw("Error removing message queue");
+	}
+}
+
+const Transport mq_transport = {
+		.name = "mq",
+		.max_size = MAXIMUM_MESSAGE_SIZE,
+		.pipelined = true,
+		.shared_size = mq_shared_size,
+		.setup = mq_setup,
+		.open = mq_open,
+		.send = mq_send,
+		.receive = mq_receive,
+		.receive_any = mq_receive_any,
+		.send_to = mq_send_to,
+		.close = mq_close,
+		.teardown = mq_teardown,
+};
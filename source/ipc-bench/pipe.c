@@ -0,0 +1,78 @@
+#include <unistd.h>
+
+#include "common/arguments.h"
+#include "common/utility.h"
+#include "ipc-bench/transport.h"
+
+// One pipe per direction and client
+typedef struct Pipes {
+	int to_client[2];
+	int to_server[2];
+} Pipes;
+
+static size_t pipe_shared_size(const struct Arguments *args) {
+	return sizeof(Pipes) * args->clients;
+}
+
+static void pipe_setup(void *shared, const struct Arguments *args) {
+	Pipes *pipes = (Pipes *)shared;
+	int client;
+
+	// Not close-on-exec, so that an exec()'d client inherits them
+	for (client = 0; client < args->clients; ++client) {
+		if (pipe(pipes[client].to_client) == -1 ||
+				pipe(pipes[client].to_server) == -1) {
+			throw("Error opening pipe");
+		}
+	}
+}
+
+static void *pipe_open(void *shared,
+											 Role role,
+											 int client,
+											 const struct Arguments *args) {
+	Pipes *pipes = (Pipes *)shared;
+	Endpoint *endpoint;
+
+	if (role == ROLE_CLIENT) {
+		// clang-format off
+		return endpoint_create_single(
+			pipes[client].to_client[0], pipes[client].to_server[1]);
+		// clang-format on
+	}
+
+	endpoint = endpoint_create(args->clients);
+	for (client = 0; client < args->clients; ++client) {
+		endpoint->in[client] = pipes[client].to_server[0];
+		endpoint->out[client] = pipes[client].to_client[1];
+	}
+
+	return endpoint;
+}
+
+static void pipe_teardown(void *shared, const struct Arguments *args) {
+	Pipes *pipes = (Pipes *)shared;
+	int client;
+
+	for (client = 0; client < args->clients; ++client) {
+		close(pipes[client].to_client[0]);
+		close(pipes[client].to_client[1]);
+		close(pipes[client].to_server[0]);
+		close(pipes[client].to_server[1]);
+	}
+}
+
+const Transport pipe_transport = {
+		.name = "pipe",
+		.pipelined = true,
+		.shared_size = pipe_shared_size,
+		.setup = pipe_setup,
+		.open = pipe_open,
+		.send = endpoint_send,
+		.receive = endpoint_receive,
+		.receive_any = endpoint_receive_any,
+		.send_to = endpoint_send_to,
+		.publish = endpoint_publish,
+		.close = endpoint_close,
+		.teardown = pipe_teardown,
+};
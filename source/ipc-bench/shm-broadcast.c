@@ -0,0 +1,170 @@
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/arguments.h"
+#include "common/guard.h"
+#include "common/ring.h"
+#include "common/utility.h"
+#include "ipc-bench/transport.h"
+
+// A ring in shared memory with one writer and a cursor per reader, like
+// shm-ring but with every reader seeing every message. The writer only
+// reuses a slot once the slowest reader has moved past it.
+typedef struct Header {
+	// Messages published so far, written by the publisher only
+	alignas(CACHE_LINE) atomic_size_t head;
+	// Rung after every message when readers may sleep (--wait)
+	Guard doorbell;
+} Header;
+
+// Messages a reader has consumed, on a cache line of its own
+typedef struct Cursor {
+	alignas(CACHE_LINE) atomic_size_t position;
+} Cursor;
+
+typedef struct BroadcastEndpoint {
+	Header *header;
+	Cursor *cursors;
+	char *slots;
+	size_t slot_size;
+	size_t mask;
+	int readers;
+	// The cursor of a reader, -1 for the publisher
+	int client;
+	// The publisher's last view of the slowest cursor
+	size_t slowest;
+	const struct Arguments *args;
+} BroadcastEndpoint;
+
+static size_t slot_size(const struct Arguments *args) {
+	return (args->size + CACHE_LINE - 1) & ~(size_t)(CACHE_LINE - 1);
+}
+
+static size_t slots_offset(const struct Arguments *args) {
+	return sizeof(Header) + args->clients * sizeof(Cursor);
+}
+
+// The same capacity as the rings of shm-ring
+static size_t shm_broadcast_shared_size(const struct Arguments *args) {
+	return slots_offset(args) + ring_slots(args->size) * slot_size(args);
+}
+
+static void shm_broadcast_setup(void *shared, const struct Arguments *args) {
+	memset(shared, 0, shm_broadcast_shared_size(args));
+}
+
+static void *shm_broadcast_open(void *shared,
+																Role role,
+																int client,
+																const struct Arguments *args) {
+	BroadcastEndpoint *endpoint = malloc(sizeof *endpoint);
+
+	endpoint->header = (Header *)shared;
+	endpoint->cursors = (Cursor *)((char *)shared + sizeof(Header));
+	endpoint->slots = (char *)shared + slots_offset(args);
+	endpoint->slot_size = slot_size(args);
+	endpoint->mask = ring_slots(args->size) - 1;
+	endpoint->readers = args->clients;
+	endpoint->client = (role == ROLE_SERVER) ? -1 : client;
+	endpoint->slowest = 0;
+	endpoint->args = args;
+
+	return endpoint;
+}
+
+static size_t slowest_cursor(BroadcastEndpoint *broadcast) {
+	size_t slowest = SIZE_MAX;
+	size_t position;
+	int reader;
+
+	for (reader = 0; reader < broadcast->readers; ++reader) {
+		// clang-format off
+		position = atomic_load_explicit(
+			&broadcast->cursors[reader].position, memory_order_acquire);
+		// clang-format on
+		if (position < slowest) slowest = position;
+	}
+
+	return slowest;
+}
+
+static void shm_broadcast_publish(void *endpoint, void *buffer, int size) {
+	BroadcastEndpoint *broadcast = (BroadcastEndpoint *)endpoint;
+	Header *header = broadcast->header;
+	const size_t head =
+			atomic_load_explicit(&header->head, memory_order_relaxed);
+
+	// Only look at the cursors when the ring seems full
+	while (head - broadcast->slowest > broadcast->mask) {
+		broadcast->slowest = slowest_cursor(broadcast);
+	}
+
+	// clang-format off
+	memcpy(broadcast->slots + (head & broadcast->mask) * broadcast->slot_size,
+				 buffer, size);
+	// clang-format on
+	atomic_store_explicit(&header->head, head + 1, memory_order_release);
+
+	if (broadcast->args->wait != WAIT_SPIN) {
+		guard_ring(&header->doorbell);
+	}
+}
+
+static int has_message(Header *header, size_t position) {
+	return atomic_load_explicit(&header->head, memory_order_acquire) != position;
+}
+
+static void wait_for_message(BroadcastEndpoint *broadcast, size_t position) {
+	Header *header = broadcast->header;
+	int spins = broadcast->args->spin_count;
+	int rung;
+
+	while (!has_message(header, position)) {
+		if (broadcast->args->wait == WAIT_SPIN) continue;
+		if (broadcast->args->wait == WAIT_HYBRID && spins-- > 0) continue;
+
+		// Reading the doorbell before checking again means that we either
+		// see the message or sleep on a doorbell that has changed
+		rung = atomic_load(&header->doorbell.token);
+		if (has_message(header, position)) break;
+		guard_sleep_while(&header->doorbell, rung);
+	}
+}
+
+static void shm_broadcast_receive(void *endpoint, void *buffer, int size) {
+	BroadcastEndpoint *broadcast = (BroadcastEndpoint *)endpoint;
+	atomic_size_t *cursor = &broadcast->cursors[broadcast->client].position;
+	const size_t position = atomic_load_explicit(cursor, memory_order_relaxed);
+
+	wait_for_message(broadcast, position);
+
+	// clang-format off
+	memcpy(buffer,
+				 broadcast->slots + (position & broadcast->mask) * broadcast->slot_size,
+				 size);
+	// clang-format on
+
+	// Hands the slot back once every reader has done the same
+	atomic_store_explicit(cursor, position + 1, memory_order_release);
+}
+
+static void shm_broadcast_close(void *endpoint) {
+	free(endpoint);
+}
+
+static void shm_broadcast_teardown(void *shared, const struct Arguments *args) {
+}
+
+const Transport shm_broadcast_transport = {
+		.name = "shm-broadcast",
+		.shared_size = shm_broadcast_shared_size,
+		.setup = shm_broadcast_setup,
+		.open = shm_broadcast_open,
+		.receive = shm_broadcast_receive,
+		.publish = shm_broadcast_publish,
+		.close = shm_broadcast_close,
+		.teardown = shm_broadcast_teardown,
+};
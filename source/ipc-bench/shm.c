@@ -0,0 +1,73 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/arguments.h"
+#include "common/guard.h"
+#include "ipc-bench/transport.h"
+
+// The shared state is the guard followed by the message, like shm
+typedef struct ShmEndpoint {
+	Guard *guard;
+	char *payload;
+	// The tokens this role waits for and hands over
+	int own;
+	int peer;
+	// For the --wait mode
+	const struct Arguments *args;
+} ShmEndpoint;
+
+static size_t shm_shared_size(const struct Arguments *args) {
+	return sizeof(Guard) + args->size;
+}
+
+static void shm_setup(void *shared, const struct Arguments *args) {
+	memset(shared, 0, sizeof(Guard));
+}
+
+static void *shm_open(void *shared,
+											Role role,
+											int client,
+											const struct Arguments *args) {
+	ShmEndpoint *endpoint = malloc(sizeof *endpoint);
+
+	endpoint->guard = (Guard *)shared;
+	endpoint->payload = (char *)shared + sizeof(Guard);
+	endpoint->own = (role == ROLE_SERVER) ? 's' : 'c';
+	endpoint->peer = (role == ROLE_SERVER) ? 'c' : 's';
+	endpoint->args = args;
+
+	return endpoint;
+}
+
+static void shm_send(void *endpoint, void *buffer, int size) {
+	ShmEndpoint *shm = (ShmEndpoint *)endpoint;
+
+	// The peer does not touch the message until it has the token
+	memcpy(shm->payload, buffer, size);
+	guard_notify(shm->guard, shm->peer);
+}
+
+static void shm_receive(void *endpoint, void *buffer, int size) {
+	ShmEndpoint *shm = (ShmEndpoint *)endpoint;
+
+	guard_wait(shm->guard, shm->own, shm->args);
+	memcpy(buffer, shm->payload, size);
+}
+
+static void shm_close(void *endpoint) {
+	free(endpoint);
+}
+
+static void shm_teardown(void *shared, const struct Arguments *args) {
+}
+
+const Transport shm_transport = {
+		.name = "shm",
+		.shared_size = shm_shared_size,
+		.setup = shm_setup,
+		.open = shm_open,
+		.send = shm_send,
+		.receive = shm_receive,
+		.close = shm_close,
+		.teardown = shm_teardown,
+};
@@ -0,0 +1,138 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "common/arguments.h"
+#include "common/sockets.h"
+#include "common/utility.h"
+#include "ipc-bench/transport.h"
+
+typedef struct Listener {
+	int socket;
+	// The port the kernel picked, so that runs do not collide
+	in_port_t port;
+} Listener;
+
+static size_t tcp_shared_size(const struct Arguments *args) {
+	return sizeof(Listener);
+}
+
+static void loopback_address(struct sockaddr_in *address, in_port_t port) {
+	memset(address, 0, sizeof *address);
+	address->sin_family = AF_INET;
+	address->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address->sin_port = port;
+}
+
+static void tcp_setup(void *shared, const struct Arguments *args) {
+	Listener *listener = (Listener *)shared;
+	struct sockaddr_in address;
+	socklen_t length = sizeof address;
+
+	if ((listener->socket = socket(AF_INET, SOCK_STREAM, 0)) == -1) {
+		throw("Error opening socket");
+	}
+
+	// Port zero lets the kernel pick a free port
+	loopback_address(&address, 0);
+	if (bind(listener->socket, (struct sockaddr *)&address, length) == -1) {
+		throw("Error binding socket");
+	}
+	if (listen(listener->socket, args->clients) == -1) {
+		throw("Error listening on socket");
+	}
+
+	// clang-format off
+	if (getsockname(
+				listener->socket, (struct sockaddr *)&address, &length) == -1) {
+		throw("Error retrieving socket address");
+	}
+	// clang-format on
+	listener->port = address.sin_port;
+}
+
+static int connect_client(const Listener *listener) {
+	struct sockaddr_in address;
+	int connection;
+
+	if ((connection = socket(AF_INET, SOCK_STREAM, 0)) == -1) {
+		throw("Error opening socket");
+	}
+
+	// Completes as soon as the connection is queued, before accept()
+	loopback_address(&address, listener->port);
+	// clang-format off
+	if (connect(
+				connection, (struct sockaddr *)&address, sizeof address) == -1) {
+		throw("Error connecting to server");
+	}
+	// clang-format on
+
+	return connection;
+}
+
+static void setup_connection(int connection) {
+	int yes = 1;
+
+	set_socket_both_buffer_sizes(connection);
+
+	// Don't let Nagle's algorithm hold back small messages
+	// clang-format off
+	if (setsockopt(connection, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof yes) == -1) {
+		throw("Error disabling Nagle's algorithm");
+	}
+	// clang-format on
+}
+
+static void *tcp_open(void *shared,
+											Role role,
+											int client,
+											const struct Arguments *args) {
+	Listener *listener = (Listener *)shared;
+	Endpoint *endpoint;
+	int connection;
+	int peer;
+
+	if (role == ROLE_CLIENT) {
+		connection = connect_client(listener);
+		setup_connection(connection);
+		return endpoint_create_single(connection, connection);
+	}
+
+	// The clients connect in any order, so the peers are numbered
+	// by when they were accepted
+	endpoint = endpoint_create(args->clients);
+	for (peer = 0; peer < args->clients; ++peer) {
+		if ((connection = accept(listener->socket, NULL, NULL)) == -1) {
+			throw("Error accepting connection");
+		}
+		setup_connection(connection);
+		endpoint->in[peer] = connection;
+		endpoint->out[peer] = connection;
+	}
+
+	return endpoint;
+}
+
+static void tcp_teardown(void *shared, const struct Arguments *args) {
+	close(((Listener *)shared)->socket);
+}
+
+const Transport tcp_transport = {
+		.name = "tcp",
+		.pipelined = true,
+		.shared_size = tcp_shared_size,
+		.setup = tcp_setup,
+		.open = tcp_open,
+		.send = endpoint_send,
+		.receive = endpoint_receive,
+		.receive_any = endpoint_receive_any,
+		.send_to = endpoint_send_to,
+		.publish = endpoint_publish,
+		.close = endpoint_close_all,
+		.teardown = tcp_teardown,
+};
@@ -0,0 +1,174 @@
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include "common/utility.h"
+#include "ipc-bench/transport.h"
+
+// Register new transports here
+const Transport *const transports[] = {&pipe_transport,
+																			 &domain_transport,
+																			 &tcp_transport,
+																			 &shm_transport,
+																			 &mq_transport,
+																			 &fifo_transport,
+																			 &eventfd_transport,
+																			 &mpsc_transport,
+																			 &shm_broadcast_transport,
+																			 &udp_multicast_transport,
+#ifdef HAVE_ZMQ
+																			 &zeromq_transport,
+#endif
+																			 NULL};
+
+const Transport *find_transport(const char *name) {
+	int index;
+
+	for (index = 0; transports[index] != NULL; ++index) {
+		if (strcmp(transports[index]->name, name) == 0) {
+			return transports[index];
+		}
+	}
+
+	return NULL;
+}
+
+Endpoint *endpoint_create(int peers) {
+	Endpoint *endpoint = malloc(sizeof *endpoint);
+
+	endpoint->peers = peers;
+	endpoint->in = calloc(peers, sizeof *endpoint->in);
+	endpoint->out = calloc(peers, sizeof *endpoint->out);
+	endpoint->epoll = -1;
+	endpoint->events = NULL;
+	endpoint->ready = 0;
+	endpoint->next = 0;
+
+	return endpoint;
+}
+
+Endpoint *endpoint_create_single(int in, int out) {
+	Endpoint *endpoint = endpoint_create(1);
+
+	endpoint->in[0] = in;
+	endpoint->out[0] = out;
+
+	return endpoint;
+}
+
+static void watch_peers(Endpoint *endpoint) {
+	struct epoll_event event;
+	int peer;
+
+	if ((endpoint->epoll = epoll_create1(EPOLL_CLOEXEC)) == -1) {
+		throw("Error creating epoll instance");
+	}
+
+	// Level-triggered: every client has at most one request in flight
+	event.events = EPOLLIN;
+	for (peer = 0; peer < endpoint->peers; ++peer) {
+		event.data.u32 = peer;
+		// clang-format off
+		if (epoll_ctl(endpoint->epoll, EPOLL_CTL_ADD,
+									endpoint->in[peer], &event) == -1) {
+			throw("Error watching peer");
+		}
+		// clang-format on
+	}
+
+	endpoint->events = calloc(endpoint->peers, sizeof *endpoint->events);
+}
+
+int endpoint_ready(Endpoint *endpoint) {
+	if (endpoint->epoll == -1) {
+		watch_peers(endpoint);
+	}
+
+	// Serve all peers of one epoll_wait() before asking again, so
+	// that no client is starved by a faster one
+	while (endpoint->next == endpoint->ready) {
+		// clang-format off
+		endpoint->ready = epoll_wait(
+			endpoint->epoll, endpoint->events, endpoint->peers, -1);
+		// clang-format on
+		endpoint->next = 0;
+		if (endpoint->ready == -1) {
+			endpoint->ready = 0;
+			if (errno != EINTR) throw("Error waiting for peers");
+		}
+	}
+
+	return endpoint->events[endpoint->next++].data.u32;
+}
+
+void endpoint_send(void *endpoint, void *buffer, int size) {
+	write_all(((Endpoint *)endpoint)->out[0], buffer, size);
+}
+
+void endpoint_receive(void *endpoint, void *buffer, int size) {
+	read_all(((Endpoint *)endpoint)->in[0], buffer, size);
+}
+
+int endpoint_receive_any(void *endpoint, void *buffer, int size) {
+	Endpoint *fds = (Endpoint *)endpoint;
+	ssize_t bytes;
+	int peer;
+
+	for (;;) {
+		peer = endpoint_ready(fds);
+		if ((bytes = read(fds->in[peer], buffer, size)) > 0) break;
+
+		// A client that is done may hang up while others still send
+		if (bytes == 0) {
+			epoll_ctl(fds->epoll, EPOLL_CTL_DEL, fds->in[peer], NULL);
+		} else if (errno != EAGAIN && errno != EINTR) {
+			throw("Error reading message");
+		}
+	}
+
+	read_all(fds->in[peer], (char *)buffer + bytes, size - bytes);
+
+	return peer;
+}
+
+void endpoint_send_to(void *endpoint, int peer, void *buffer, int size) {
+	write_all(((Endpoint *)endpoint)->out[peer], buffer, size);
+}
+
+void endpoint_publish(void *endpoint, void *buffer, int size) {
+	Endpoint *fds = (Endpoint *)endpoint;
+	int peer;
+
+	for (peer = 0; peer < fds->peers; ++peer) {
+		write_all(fds->out[peer], buffer, size);
+	}
+}
+
+void endpoint_close(void *endpoint) {
+	Endpoint *fds = (Endpoint *)endpoint;
+
+	if (fds->epoll != -1) {
+		close(fds->epoll);
+	}
+
+	free(fds->events);
+	free(fds->in);
+	free(fds->out);
+	free(fds);
+}
+
+void endpoint_close_all(void *endpoint) {
+	Endpoint *fds = (Endpoint *)endpoint;
+	int peer;
+
+	for (peer = 0; peer < fds->peers; ++peer) {
+		close(fds->in[peer]);
+		if (fds->out[peer] != fds->in[peer]) {
+			close(fds->out[peer]);
+		}
+	}
+
+	endpoint_close(endpoint);
+}
@@ -0,0 +1,123 @@
+#ifndef IPC_BENCH_TRANSPORT_H
+#define IPC_BENCH_TRANSPORT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct Arguments;
+struct epoll_event;
+
+/******************** DEFINITIONS ********************/
+
+typedef enum Role { ROLE_SERVER, ROLE_CLIENT } Role;
+
+// A transport the driver can run. The server and client of a run share a
+// block of memory that survives fork() and exec(), which holds everything
+// a role needs to connect (descriptors, keys, ports or the messages). In a
+// fan-in run, args->clients clients share it and one server serves them all.
+typedef struct Transport {
+	const char *name;
+
+	// Largest message the transport can carry (0 = no limit)
+	int max_size;
+
+	// Whether a client may have several messages in flight and send
+	// and receive from two threads at once (needed by --rate)
+	bool pipelined;
+
+	// Bytes of shared state of a run
+	size_t (*shared_size)(const struct Arguments *args);
+
+	// Creates the resources of a run, before the roles start
+	void (*setup)(void *shared, const struct Arguments *args);
+
+	// Connects a role (and the index of a client) to the resources
+	void *(*open)(void *shared,
+								Role role,
+								int client,
+								const struct Arguments *args);
+
+	// Sends or receives one message of the given size, the server
+	// talks to the first client. Broadcast-only transports cannot send.
+	void (*send)(void *endpoint, void *buffer, int size);
+	void (*receive)(void *endpoint, void *buffer, int size);
+
+	// Fan-in only (NULL if not supported): the server receives from
+	// whichever client is ready, returning its peer index, and replies
+	// to a peer. Peer indices need not match the client indices.
+	int (*receive_any)(void *endpoint, void *buffer, int size);
+	void (*send_to)(void *endpoint, int peer, void *buffer, int size);
+
+	// Broadcast only (NULL if not supported): the server sends one
+	// message to every client, which receive() it
+	void (*publish)(void *endpoint, void *buffer, int size);
+
+	// Releases an endpoint
+	void (*close)(void *endpoint);
+
+	// Releases the resources of a run, after both roles are done
+	void (*teardown)(void *shared, const struct Arguments *args);
+} Transport;
+
+// The endpoint of transports over file descriptors. A client has one
+// peer, a server one per client, which it watches with epoll.
+typedef struct Endpoint {
+	int peers;
+	int *in;
+	int *out;
+
+	// Lazily created by endpoint_ready()
+	int epoll;
+	struct epoll_event *events;
+	// Events left from the last epoll_wait()
+	int ready;
+	int next;
+} Endpoint;
+
+/******************** INTERFACE ********************/
+
+extern const Transport pipe_transport;
+extern const Transport domain_transport;
+extern const Transport tcp_transport;
+extern const Transport shm_transport;
+extern const Transport mq_transport;
+extern const Transport fifo_transport;
+extern const Transport eventfd_transport;
+extern const Transport mpsc_transport;
+extern const Transport shm_broadcast_transport;
+extern const Transport udp_multicast_transport;
+#ifdef HAVE_ZMQ
+extern const Transport zeromq_transport;
+#endif
+
+// All registered transports, terminated by NULL
+extern const Transport *const transports[];
+
+// Returns the transport with the given name, or NULL
+const Transport *find_transport(const char *name);
+
+// Allocates an endpoint for the given number of peers, whose descriptors
+// the transport then fills in
+Endpoint *endpoint_create(int peers);
+
+// Allocates an endpoint with a single peer
+Endpoint *endpoint_create_single(int in, int out);
+
+// Waits until a peer has data to read and returns its index
+int endpoint_ready(Endpoint *endpoint);
+
+void endpoint_send(void *endpoint, void *buffer, int size);
+void endpoint_receive(void *endpoint, void *buffer, int size);
+int endpoint_receive_any(void *endpoint, void *buffer, int size);
+void endpoint_send_to(void *endpoint, int peer, void *buffer, int size);
+
+// Writes the message to every peer in turn
+void endpoint_publish(void *endpoint, void *buffer, int size);
+
+// Frees the endpoint, the descriptors belong to the shared state
+void endpoint_close(void *endpoint);
+
+// Closes the descriptors of every peer as well
+void endpoint_close_all(void *endpoint);
+
+#endif /* IPC_BENCH_TRANSPORT_H */
@@ -0,0 +1,206 @@
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "common/arguments.h"
+#include "common/sockets.h"
+#include "common/utility.h"
+#include "ipc-bench/transport.h"
+
+// An administratively scoped group, the traffic never leaves loopback
+#define GROUP_ADDRESS "239.255.73.1"
+
+// Largest payload of a UDP datagram over IPv4
+#define MAXIMUM_DATAGRAM 65507
+
+typedef struct Group {
+	// Holds the port the kernel picked, so that runs do not collide
+	int socket;
+	in_port_t port;
+	// The driver, which publishes and waits for every subscriber
+	pid_t publisher;
+} Group;
+
+// The publisher of the subscribers in this process
+static pid_t publisher;
+
+static size_t udp_multicast_shared_size(const struct Arguments *args) {
+	return sizeof(Group);
+}
+
+static void group_address(struct sockaddr_in *address, in_port_t port) {
+	memset(address, 0, sizeof *address);
+	address->sin_family = AF_INET;
+	address->sin_addr.s_addr = inet_addr(GROUP_ADDRESS);
+	address->sin_port = port;
+}
+
+static int group_socket() {
+	int descriptor;
+	int yes = 1;
+
+	if ((descriptor = socket(AF_INET, SOCK_DGRAM, 0)) == -1) {
+		throw("Error opening socket");
+	}
+
+	// All subscribers bind to the same group and port
+	// clang-format off
+	if (setsockopt(descriptor, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof yes) == -1) {
+		throw("Error allowing to reuse the address");
+	}
+	// clang-format on
+
+	return descriptor;
+}
+
+static void udp_multicast_setup(void *shared, const struct Arguments *args) {
+	Group *group = (Group *)shared;
+	struct sockaddr_in address;
+	socklen_t length = sizeof address;
+	int no = 0;
+
+	// Binding to port zero reserves a free one for the subscribers,
+	// this socket never joins the group and so receives nothing
+	group->socket = group_socket();
+	group_address(&address, 0);
+	if (bind(group->socket, (struct sockaddr *)&address, length) == -1) {
+		throw("Error binding socket");
+	}
+	// clang-format off
+	if (getsockname(
+				group->socket, (struct sockaddr *)&address, &length) == -1) {
+		throw("Error retrieving socket address");
+	}
+	// clang-format on
+	group->port = address.sin_port;
+	group->publisher = getpid();
+
+	// Don't let the subscribers' memberships deliver to it anyway
+	// clang-format off
+	if (setsockopt(group->socket, IPPROTO_IP, IP_MULTICAST_ALL,
+								 &no, sizeof no) == -1) {
+		throw("Error leaving multicast groups");
+	}
+	// clang-format on
+}
+
+static int open_subscriber(const Group *group) {
+	struct sockaddr_in address;
+	struct ip_mreq membership;
+	int descriptor = group_socket();
+
+	group_address(&address, group->port);
+	// clang-format off
+	if (bind(descriptor, (struct sockaddr *)&address, sizeof address) == -1) {
+		throw("Error binding socket");
+	}
+	// clang-format on
+
+	membership.imr_multiaddr.s_addr = inet_addr(GROUP_ADDRESS);
+	membership.imr_interface.s_addr = htonl(INADDR_LOOPBACK);
+	// clang-format off
+	if (setsockopt(descriptor, IPPROTO_IP, IP_ADD_MEMBERSHIP,
+								 &membership, sizeof membership) == -1) {
+		throw("Error joining multicast group");
+	}
+	// clang-format on
+
+	set_socket_both_buffer_sizes(descriptor);
+	set_socket_both_timeouts(descriptor, LOSS_TIMEOUT, 0);
+
+	return descriptor;
+}
+
+static int open_publisher(const Group *group) {
+	struct sockaddr_in address;
+	struct in_addr interface;
+	unsigned char yes = 1;
+	int descriptor;
+
+	if ((descriptor = socket(AF_INET, SOCK_DGRAM, 0)) == -1) {
+		throw("Error opening socket");
+	}
+
+	// Send through loopback and deliver to local members
+	interface.s_addr = htonl(INADDR_LOOPBACK);
+	// clang-format off
+	if (setsockopt(descriptor, IPPROTO_IP, IP_MULTICAST_IF,
+								 &interface, sizeof interface) == -1 ||
+			setsockopt(descriptor, IPPROTO_IP, IP_MULTICAST_LOOP,
+								 &yes, sizeof yes) == -1) {
+		throw("Error setting up multicast");
+	}
+	// clang-format on
+
+	set_socket_both_buffer_sizes(descriptor);
+
+	group_address(&address, group->port);
+	// clang-format off
+	if (connect(descriptor, (struct sockaddr *)&address, sizeof address) == -1) {
+		throw("Error connecting to multicast group");
+	}
+	// clang-format on
+
+	return descriptor;
+}
+
+static void *udp_multicast_open(void *shared,
+																Role role,
+																int client,
+																const struct Arguments *args) {
+	const Group *group = (const Group *)shared;
+	int descriptor;
+
+	if (role == ROLE_SERVER) {
+		descriptor = open_publisher(group);
+	} else {
+		descriptor = open_subscriber(group);
+		publisher = group->publisher;
+	}
+
+	return endpoint_create_single(descriptor, descriptor);
+}
+
+static void udp_multicast_publish(void *endpoint, void *buffer, int size) {
+	// One datagram reaches every member
+	if (send(((Endpoint *)endpoint)->out[0], buffer, size, 0) < size) {
+		throw("Error sending datagram");
+	}
+}
+
+static void udp_multicast_receive(void *endpoint, void *buffer, int size) {
+	ssize_t bytes = recv(((Endpoint *)endpoint)->in[0], buffer, size, 0);
+
+	// A datagram is never split, but may be lost
+	if (bytes == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+		// The publisher would wait for this subscriber forever, unless it is a
+		// thread of this process
+		if (publisher != getpid()) {
+			kill(publisher, SIGTERM);
+		}
+		terminate("No datagram arrived in time, the group lost a message\n");
+	} else if (bytes < size) {
+		throw("Error receiving datagram");
+	}
+}
+
+static void udp_multicast_teardown(void *shared, const struct Arguments *args) {
+	close(((Group *)shared)->socket);
+}
+
+const Transport udp_multicast_transport = {
+		.name = "udp-multicast",
+		.max_size = MAXIMUM_DATAGRAM,
+		.shared_size = udp_multicast_shared_size,
+		.setup = udp_multicast_setup,
+		.open = udp_multicast_open,
+		.receive = udp_multicast_receive,
+		.publish = udp_multicast_publish,
+		.close = endpoint_close_all,
+		.teardown = udp_multicast_teardown,
+};
@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <zmq.h>
+
+#include "common/arguments.h"
+#include "common/utility.h"
+#include "ipc-bench/transport.h"
+
+// PUB/SUB over a UNIX-domain socket, built only if ZMQ was found
+typedef struct Address {
+	char path[64];
+} Address;
+
+typedef struct ZmqEndpoint {
+	void *context;
+	void *socket;
+} ZmqEndpoint;
+
+static size_t zeromq_shared_size(const struct Arguments *args) {
+	return sizeof(Address);
+}
+
+static void zeromq_setup(void *shared, const struct Arguments *args) {
+	static int runs = 0;
+
+	// clang-format off
+	snprintf(((Address *)shared)->path, sizeof(Address),
+					 "ipc:///tmp/ipc_bench_zmq_%d_%d", (int)getpid(), runs++);
+	// clang-format on
+}
+
+static void open_publisher(ZmqEndpoint *zmq,
+													 const Address *address,
+													 int subscribers) {
+	char subscription[8];
+	int yes = 1;
+
+	// An XPUB socket hands us the subscriptions, so that we can wait for
+	// every subscriber instead of losing the first messages to them
+	if ((zmq->socket = zmq_socket(zmq->context, ZMQ_XPUB)) == NULL) {
+		throw("Error creating socket");
+	}
+	// clang-format off
+	if (zmq_setsockopt(zmq->socket, ZMQ_XPUB_VERBOSE, &yes, sizeof yes) == -1) {
+		throw("Error making subscriptions visible");
+	}
+	// clang-format on
+	if (zmq_bind(zmq->socket, address->path) == -1) {
+		throw("Error binding socket to address");
+	}
+
+	for (; subscribers > 0; --subscribers) {
+		// clang-format off
+		if (zmq_recv(
+					zmq->socket, subscription, sizeof subscription, 0) == -1) {
+			throw("Error receiving subscription");
+		}
+		// clang-format on
+	}
+}
+
+static void open_subscriber(ZmqEndpoint *zmq, const Address *address) {
+	if ((zmq->socket = zmq_socket(zmq->context, ZMQ_SUB)) == NULL) {
+		throw("Error creating socket");
+	}
+	// Everything, the empty prefix matches all messages
+	if (zmq_setsockopt(zmq->socket, ZMQ_SUBSCRIBE, "", 0) == -1) {
+		throw("Error subscribing");
+	}
+	// Connecting before the publisher binds is fine, ZMQ retries
+	if (zmq_connect(zmq->socket, address->path) == -1) {
+		throw("Error connecting to publisher");
+	}
+}
+
+static void *zeromq_open(void *shared,
+												 Role role,
+												 int client,
+												 const struct Arguments *args) {
+	ZmqEndpoint *endpoint = malloc(sizeof *endpoint);
+
+	if ((endpoint->context = zmq_ctx_new()) == NULL) {
+		throw("Error creating ZMQ context");
+	}
+
+	if (role == ROLE_SERVER) {
+		open_publisher(endpoint, (const Address *)shared, args->clients);
+	} else {
+		open_subscriber(endpoint, (const Address *)shared);
+	}
+
+	return endpoint;
+}
+
+static void zeromq_publish(void *endpoint, void *buffer, int size) {
+	if (zmq_send(((ZmqEndpoint *)endpoint)->socket, buffer, size, 0) < size) {
+		throw("Error publishing message");
+	}
+}
+
+static void zeromq_receive(void *endpoint, void *buffer, int size) {
+	if (zmq_recv(((ZmqEndpoint *)endpoint)->socket, buffer, size, 0) < size) {
+		throw("Error receiving message");
+	}
+}
+
+static void zeromq_close(void *endpoint) {
+	ZmqEndpoint *zmq = (ZmqEndpoint *)endpoint;
+
+	zmq_close(zmq->socket);
+	zmq_ctx_destroy(zmq->context);
+	free(zmq);
+}
+
+static void zeromq_teardown(void *shared, const struct Arguments *args) {
+	// Skip the "ipc://" scheme
+	remove(((Address *)shared)->path + 6);
+}
+
+const Transport zeromq_transport = {
+		.name = "zeromq",
+		.shared_size = zeromq_shared_size,
+		.setup = zeromq_setup,
+		.open = zeromq_open,
+		.receive = zeromq_receive,
+		.publish = zeromq_publish,
+		.close = zeromq_close,
+		.teardown = zeromq_teardown,
+};
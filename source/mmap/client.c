@@ -1,6 +1,5 @@
 #include <fcntl.h>
 #include <signal.h>
-#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -8,6 +7,8 @@
 #include <unistd.h>
 
 #include "common/common.h"
+#include "common/guard.h"
+#include "common/stream.h"
 
 int get_file_descriptor() {
 	// Open a new file descriptor, creating the file if it does not exist
@@ -21,27 +22,29 @@ int get_file_descriptor() {
 	return file_descriptor;
 }
 
-void mmap_wait(atomic_char* guard) {
-	while (atomic_load(guard) != 'c')
-		;
+void mmap_wait(Guard* guard, struct Arguments* args) {
+	guard_wait(guard, 'c', args);
 }
 
-void mmap_notify(atomic_char* guard) {
-	atomic_store(guard, 's');
+void mmap_notify(Guard* guard) {
+	guard_notify(guard, 's');
 }
 
 void communicate(char* file_memory, struct Arguments* args) {
+	int message;
+
 	// Buffer into which to read data
 	void* buffer = malloc(args->size);
-	atomic_char* guard = (atomic_char*)file_memory;
+	Guard* guard = (Guard*)file_memory;
+	char* payload = file_memory + sizeof(Guard);
 
 	mmap_notify(guard);
 
-	for (; args->count > 0; --args->count) {
-		mmap_wait(guard);
+	for (message = total_messages(args); message > 0; --message) {
+		mmap_wait(guard, args);
 
-		memcpy(buffer, file_memory, args->size);
-		memset(file_memory, '*', args->size);
+		memcpy(buffer, payload, args->size);
+		memset(payload, '*', args->size);
 
 		mmap_notify(guard);
 	}
@@ -50,6 +53,19 @@ void communicate(char* file_memory, struct Arguments* args) {
 }
 
 
+void stream_messages(char* file_memory, struct Arguments* args) {
+	Guard* guard = (Guard*)file_memory;
+	RingChannel ring;
+	Channel channel;
+
+	// Wait until the server has set up the ring
+	mmap_wait(guard, args);
+	ring_channel(&channel, &ring, file_memory + sizeof(Guard), args->size);
+	mmap_notify(guard);
+
+	stream_client(&channel, args);
+}
+
 int main(int argc, char* argv[]) {
 	// The memory region to which the file will be mapped
 	void* file_memory;
@@ -83,7 +99,7 @@ int main(int argc, char* argv[]) {
 	// clang-format off
   file_memory = mmap(
 		NULL,
-		args.size,
+		sizeof(Guard) + message_memory_size(&args),
 		PROT_READ | PROT_WRITE,
 		MAP_SHARED,
 		file_descriptor,
@@ -115,12 +131,16 @@ int main(int argc, char* argv[]) {
 		throw("Error closing file!");
 	}
 
-	communicate(file_memory, &args);
+	if (args.mode == MODE_PINGPONG) {
+		communicate(file_memory, &args);
+	} else {
+		stream_messages(file_memory, &args);
+	}
 
 	// Unmap the file from the process memory
 	// Actually unncessary because the OS will do
 	// this automatically when the process terminates
-	if (munmap(file_memory, args.size) < 0) {
+	if (munmap(file_memory, sizeof(Guard) + message_memory_size(&args)) < 0) {
 		throw("Error unmapping file!");
 	}
 
@@ -1,6 +1,5 @@
 #include <fcntl.h>
 #include <signal.h>
-#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -8,6 +7,8 @@
 #include <unistd.h>
 
 #include "common/common.h"
+#include "common/guard.h"
+#include "common/stream.h"
 
 void make_space(int file_descriptor, int bytes) {
 	lseek(file_descriptor, bytes + 1, SEEK_SET);
@@ -32,33 +33,33 @@ int get_file_descriptor(int bytes) {
 	return file_descriptor;
 }
 
-void mmap_wait(atomic_char *guard) {
-	while (atomic_load(guard) != 's')
-		;
+void mmap_wait(Guard *guard, struct Arguments *args) {
+	guard_wait(guard, 's', args);
 }
 
-void mmap_notify(atomic_char *guard) {
-	atomic_store(guard, 'c');
+void mmap_notify(Guard *guard) {
+	guard_notify(guard, 'c');
 }
 
 void communicate(char *file_memory, struct Arguments *args) {
 	struct Benchmarks bench;
 	int message;
 	void *buffer = malloc(args->size);
-	atomic_char *guard = (atomic_char *)file_memory;
+	Guard *guard = (Guard *)file_memory;
+	char *payload = file_memory + sizeof(Guard);
 
-	mmap_wait(guard);
+	mmap_wait(guard, args);
 	setup_benchmarks(&bench);
 
-	for (message = 0; message < args->count; ++message) {
+	for (message = total_messages(args); message > 0; --message) {
 		bench.single_start = now();
 
-		memset(file_memory, '*', args->size);
+		memset(payload, '*', args->size);
 
 		mmap_notify(guard);
-		mmap_wait(guard);
+		mmap_wait(guard, args);
 
-		memcpy(buffer, file_memory, args->size);
+		memcpy(buffer, payload, args->size);
 
 		benchmark(&bench);
 	}
@@ -67,6 +68,22 @@ void communicate(char *file_memory, struct Arguments *args) {
 	free(buffer);
 }
 
+void stream_messages(char *file_memory, struct Arguments *args) {
+	Guard *guard = (Guard *)file_memory;
+	RingChannel ring;
+	Channel channel;
+
+	// The memory may be left over from an earlier run
+	memset(file_memory + sizeof(Guard), 0, ring_channel_size(args->size));
+	ring_channel(&channel, &ring, file_memory + sizeof(Guard), args->size);
+
+	// Tell the client the ring is ready, then wait for it
+	mmap_notify(guard);
+	mmap_wait(guard, args);
+
+	stream_server(&channel, args);
+}
+
 int main(int argc, char *argv[]) {
 	// The memory region to which the file will be mapped
 	void *file_memory;
@@ -77,7 +94,7 @@ int main(int argc, char *argv[]) {
 	// Fetch command-line arguments
 	struct Arguments args;
 	parse_arguments(&args, argc, argv);
-	file_descriptor = get_file_descriptor(args.size);
+	file_descriptor = get_file_descriptor(sizeof(Guard) + message_memory_size(&args));
 
 	/*
 		Arguments:
@@ -100,7 +117,7 @@ int main(int argc, char *argv[]) {
 	// clang-format off
   file_memory = mmap(
 		NULL,
-		1 + args.size,
+		sizeof(Guard) + message_memory_size(&args),
 		PROT_READ | PROT_WRITE,
 		MAP_SHARED,
 		file_descriptor,
@@ -132,12 +149,16 @@ int main(int argc, char *argv[]) {
 		throw("Error closing file!");
 	}
 
-	communicate(file_memory, &args);
+	if (args.mode == MODE_PINGPONG) {
+		communicate(file_memory, &args);
+	} else {
+		stream_messages(file_memory, &args);
+	}
 
 	// Unmap the file from the process memory
 	// Actually unncessary because the OS will do
 	// this automatically when the process terminates
-	if (munmap(file_memory, args.size) < 0) {
+	if (munmap(file_memory, sizeof(Guard) + message_memory_size(&args)) < 0) {
 		throw("Error unmapping file!");
 	}
 
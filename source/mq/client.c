@@ -3,14 +3,16 @@
 #include <string.h>
 
 #include "common/common.h"
+#include "common/stream.h"
 #include "mq/mq-common.h"
 
 void communicate(int mq, struct Arguments* args) {
 	struct Message* message;
+	int index;
 
 	message = create_message(args);
 
-	for (; args->count > 0; --args->count) {
+	for (index = total_messages(args); index > 0; --index) {
 		// Fetch a message from the queue.
 		// Arguments:
 		// 1. The message-queue identifier.
@@ -48,6 +50,15 @@ void communicate(int mq, struct Arguments* args) {
 	free(message);
 }
 
+void stream_messages(int mq, struct Arguments* args) {
+	struct Queue queue;
+	Channel channel;
+
+	queue_channel(&channel, &queue, mq, args);
+	stream_client(&channel, args);
+	free(queue.message);
+}
+
 int create_mq() {
 	int mq;
 	key_t key;
@@ -82,7 +93,12 @@ int main(int argc, char* argv[]) {
 	}
 
 	mq = create_mq();
-	communicate(mq, &args);
+
+	if (args.mode == MODE_PINGPONG) {
+		communicate(mq, &args);
+	} else {
+		stream_messages(mq, &args);
+	}
 
 	return EXIT_SUCCESS;
 }
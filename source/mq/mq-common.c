@@ -3,6 +3,8 @@
 #include <string.h>
 
 #include "common/arguments.h"
+#include "common/stream.h"
+#include "common/utility.h"
 #include "mq/mq-common.h"
 
 struct Message* create_message(struct Arguments* args) {
@@ -13,3 +15,59 @@ struct Message* create_message(struct Arguments* args) {
 
 	return message;
 }
+
+static void queue_send(void* context, void* buffer, int size) {
+	struct Queue* queue = (struct Queue*)context;
+
+	queue->message->type = SERVER_MESSAGE;
+	memcpy(queue->message->buffer, buffer, size);
+
+	// Unlike ping-pong, the queue may fill up, so block rather than fail
+	if (msgsnd(queue->mq, queue->message, size, 0) == -1) {
+		throw("Error sending on server-side");
+	}
+}
+
+static void queue_receive(void* context, void* buffer, int size) {
+	struct Queue* queue = (struct Queue*)context;
+
+	// clang-format off
+	if (msgrcv(queue->mq, queue->message, size, SERVER_MESSAGE, 0) < size) {
+		throw("Error receiving on client-side");
+	}
+	// clang-format on
+
+	memcpy(buffer, queue->message->buffer, size);
+}
+
+static void queue_acknowledge(void* context) {
+	struct Message ack = {CLIENT_MESSAGE};
+
+	// An empty message of the client's type
+	if (msgsnd(((struct Queue*)context)->mq, &ack, 0, 0) == -1) {
+		throw("Error sending acknowledgement on client-side");
+	}
+}
+
+static void queue_wait_for_ack(void* context) {
+	struct Message ack;
+
+	if (msgrcv(((struct Queue*)context)->mq, &ack, 0, CLIENT_MESSAGE, 0) == -1) {
+		throw("Error receiving acknowledgement on server-side");
+	}
+}
+
+void queue_channel(struct Channel* channel,
+									 struct Queue* queue,
+									 int mq,
+									 struct Arguments* args) {
+	queue->mq = mq;
+	queue->message = create_message(args);
+
+	channel->context = queue;
+	channel->send = queue_send;
+	channel->receive = queue_receive;
+	channel->acknowledge = queue_acknowledge;
+	channel->wait_for_ack = queue_wait_for_ack;
+	channel->peer = 0;
+}
@@ -22,8 +22,21 @@ struct Message {
 	char buffer[];
 };
 
+// Context of a stream-mode channel over the queue
+struct Queue {
+	int mq;
+	struct Message* message;
+};
+
 struct Arguments;
+struct Channel;
 
 struct Message* create_message(struct Arguments* args);
 
+// Sets up a channel over the queue (the message is created here)
+void queue_channel(struct Channel* channel,
+									 struct Queue* queue,
+									 int mq,
+									 struct Arguments* args);
+
 #endif /* IPC_BENCH_MQ_COMMON_H */
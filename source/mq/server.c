@@ -5,6 +5,7 @@
 #include <sys/types.h>
 
 #include "common/common.h"
+#include "common/stream.h"
 #include "mq/mq-common.h"
 
 void cleanup(int mq, struct Message* message) {
@@ -29,7 +30,7 @@ void communicate(int mq, struct Arguments* args) {
 	message = create_message(args);
 	setup_benchmarks(&bench);
 
-	for (index = 0; index < args->count; ++index) {
+	for (index = total_messages(args); index > 0; --index) {
 		bench.single_start = now();
 
 		// Messages in message-queues are associated with
@@ -79,6 +80,15 @@ void communicate(int mq, struct Arguments* args) {
 	cleanup(mq, message);
 }
 
+void stream_messages(int mq, struct Arguments* args) {
+	struct Queue queue;
+	Channel channel;
+
+	queue_channel(&channel, &queue, mq, args);
+	stream_server(&channel, args);
+	cleanup(mq, queue.message);
+}
+
 int create_mq() {
 	int mq;
 
@@ -127,7 +137,12 @@ int main(int argc, char* argv[]) {
 	limit_message_size(&args);
 
 	mq = create_mq();
-	communicate(mq, &args);
+
+	if (args.mode == MODE_PINGPONG) {
+		communicate(mq, &args);
+	} else {
+		stream_messages(mq, &args);
+	}
 
 	return EXIT_SUCCESS;
 }
@@ -0,0 +1,347 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "common/common.h"
+#include "common/results.h"
+#include "common/stream.h"
+
+// Where the client splices messages to with --splice
+#define SINK_PATH "/dev/null"
+
+// The ends of a side of a pipe from the server to the client and one for
+// acknowledgements, used with plain read() and write() (no stdio, no signals)
+typedef struct Side {
+	Descriptors pipes;
+
+	// The server gifts its pages to the pipe with vmsplice() (--vmsplice)
+	bool gift;
+	// The client moves messages into the sink with splice() (--splice)
+	bool sink;
+	int sink_descriptor;
+
+	// Gifted pages may not be written while in the pipe, so the server
+	// cycles through more messages than the pipe can hold
+	char *messages;
+	int message_count;
+	size_t message_stride;
+	int next;
+
+	// System calls of the side
+	long calls;
+} Side;
+
+void write_message(Side *side, void *buffer, int size) {
+	ssize_t bytes;
+
+	while (size > 0) {
+		++side->calls;
+		if ((bytes = write(side->pipes.data, buffer, size)) == -1) {
+			if (errno == EINTR) continue;
+			throw("Error writing to pipe");
+		}
+		buffer = (char *)buffer + bytes;
+		size -= bytes;
+	}
+}
+
+void gift_message(Side *side, int size) {
+	struct iovec vector;
+	ssize_t bytes;
+
+	// The pages were filled once, like the buffer of the other senders
+	vector.iov_base = side->messages + side->next * side->message_stride;
+	vector.iov_len = size;
+	side->next = (side->next + 1) % side->message_count;
+
+	// A full pipe takes only part of the message
+	while (vector.iov_len > 0) {
+		++side->calls;
+		// clang-format off
+		if ((bytes = vmsplice(side->pipes.data, &vector, 1,
+													SPLICE_F_GIFT)) == -1) {
+			if (errno == EINTR) continue;
+			throw("Error splicing pages into pipe");
+		}
+		// clang-format on
+		vector.iov_base = (char *)vector.iov_base + bytes;
+		vector.iov_len -= bytes;
+	}
+}
+
+void read_message(Side *side, void *buffer, int size) {
+	ssize_t bytes;
+
+	while (size > 0) {
+		++side->calls;
+		if ((bytes = read(side->pipes.data, buffer, size)) == -1) {
+			if (errno == EINTR) continue;
+			throw("Error reading from pipe");
+		} else if (bytes == 0) {
+			terminate("Pipe closed by the server\n");
+		}
+		buffer = (char *)buffer + bytes;
+		size -= bytes;
+	}
+}
+
+void sink_message(Side *side, int size) {
+	ssize_t bytes;
+
+	// The data goes from the pipe to the sink without visiting user space
+	while (size > 0) {
+		++side->calls;
+		// clang-format off
+		if ((bytes = splice(side->pipes.data, NULL,
+												side->sink_descriptor, NULL,
+												size, SPLICE_F_MOVE)) == -1) {
+			if (errno == EINTR) continue;
+			throw("Error splicing from pipe");
+		} else if (bytes == 0) {
+			terminate("Pipe closed by the server\n");
+		}
+		// clang-format on
+		size -= bytes;
+	}
+}
+
+void splice_send(void *context, void *buffer, int size) {
+	Side *side = (Side *)context;
+
+	if (side->gift) {
+		gift_message(side, size);
+	} else {
+		write_message(side, buffer, size);
+	}
+}
+
+void splice_receive(void *context, void *buffer, int size) {
+	Side *side = (Side *)context;
+
+	if (side->sink) {
+		sink_message(side, size);
+	} else {
+		read_message(side, buffer, size);
+	}
+}
+
+void splice_acknowledge(void *context) {
+	Side *side = (Side *)context;
+
+	++side->calls;
+	if (write(side->pipes.ack, "", 1) != 1) {
+		throw("Error acknowledging message");
+	}
+}
+
+void splice_wait_for_ack(void *context) {
+	Side *side = (Side *)context;
+	char ack;
+
+	++side->calls;
+	if (read(side->pipes.ack, &ack, 1) != 1) {
+		throw("Error waiting for acknowledgement");
+	}
+}
+
+void splice_channel(Channel *channel, Side *side) {
+	channel->context = side;
+	channel->send = splice_send;
+	channel->receive = splice_receive;
+	channel->acknowledge = splice_acknowledge;
+	channel->wait_for_ack = splice_wait_for_ack;
+	channel->peer = 0;
+}
+
+// Makes the pipe hold the requested bytes, or at least one message
+int setup_pipe_size(int descriptor, int requested, int size) {
+	int capacity;
+
+	if ((capacity = fcntl(descriptor, F_GETPIPE_SZ)) == -1) {
+		throw("Error getting pipe size");
+	}
+
+	if (requested == 0 && size > capacity) {
+		requested = size;
+	}
+
+	// Beyond /proc/sys/fs/pipe-max-size only with CAP_SYS_RESOURCE
+	if (requested > 0 && fcntl(descriptor, F_SETPIPE_SZ, requested) == -1) {
+		warn("Could not resize the pipe, see /proc/sys/fs/pipe-max-size");
+	}
+
+	return fcntl(descriptor, F_GETPIPE_SZ);
+}
+
+void setup_gift(Side *side, int capacity, int size) {
+	const size_t page = sysconf(_SC_PAGESIZE);
+	const size_t pages = (size + page - 1) / page;
+	int message;
+
+	// Every message takes at least one slot of the pipe per page, and one
+	// more may be half written when the pipe fills up
+	side->message_stride = pages * page;
+	side->message_count = (capacity / page) / pages + 2;
+	side->next = 0;
+
+	// clang-format off
+	side->messages = aligned_alloc(
+		page, side->message_count * side->message_stride);
+	// clang-format on
+	if (side->messages == NULL) {
+		throw("Error allocating pages to gift");
+	}
+
+	for (message = 0; message < side->message_count; ++message) {
+		memset(side->messages + message * side->message_stride, '*', size);
+	}
+}
+
+void client_communicate(Side *side, struct Arguments *args) {
+	void *buffer = malloc(args->size);
+	Channel channel;
+	int message;
+
+	splice_channel(&channel, side);
+
+	if (args->mode != MODE_PINGPONG) {
+		stream_client(&channel, args);
+		free(buffer);
+		return;
+	}
+
+	for (message = total_messages(args); message > 0; --message) {
+		splice_receive(side, buffer, args->size);
+		splice_acknowledge(side);
+	}
+
+	free(buffer);
+}
+
+void server_communicate(Side *side, struct Arguments *args, pid_t client) {
+	const int total = total_messages(args);
+	void *buffer = malloc(args->size);
+	struct Benchmarks bench;
+	Results results;
+	Channel channel;
+	int message;
+
+	memset(buffer, '*', args->size);
+	splice_channel(&channel, side);
+	channel.peer = client;
+
+	if (args->mode != MODE_PINGPONG) {
+		stream_server(&channel, args);
+		free(buffer);
+		return;
+	}
+
+	setup_benchmarks(&bench);
+	benchmarks_count_peer(&bench, client);
+
+	// Like pipe, the message only travels one way and the client answers
+	// with an acknowledgement
+	for (message = total; message > 0; --message) {
+		bench.single_start = now();
+
+		splice_send(side, buffer, args->size);
+		splice_wait_for_ack(side);
+
+		benchmark(&bench);
+	}
+
+	summarize(&bench, args, &results);
+	results.syscalls = side->calls / (double)total;
+	print_results(&results, args);
+	free(buffer);
+}
+
+void communicate(Side *side,
+								 int data[2],
+								 int acks[2],
+								 struct Arguments *args) {
+	pid_t pid;
+
+	if ((pid = fork()) == -1) {
+		throw("Error forking process");
+	}
+
+	if (pid == (pid_t)0) {
+		pin_thread(args->client_cpu);
+		close(data[1]);
+		close(acks[0]);
+		side->pipes.data = data[0];
+		side->pipes.ack = acks[1];
+		client_communicate(side, args);
+	} else {
+		pin_thread(args->server_cpu);
+		close(data[0]);
+		close(acks[1]);
+		side->pipes.data = data[1];
+		side->pipes.ack = acks[0];
+		server_communicate(side, args, pid);
+		waitpid(pid, NULL, 0);
+	}
+
+	close(side->pipes.data);
+	close(side->pipes.ack);
+}
+
+// One-way messages over a pipe with raw system calls, optionally without
+// copies through vmsplice() and splice():
+// 		server --> client
+//         \<-ack--/
+int main(int argc, char *argv[]) {
+	struct Arguments args;
+	Side side;
+	int requested = 0;
+	int capacity;
+	int data[2];
+	int acks[2];
+
+	parse_arguments(&args, argc, argv);
+	side.gift = check_flag("vmsplice", argc, argv);
+	side.sink = check_flag("splice", argc, argv);
+	side.calls = 0;
+	side.messages = NULL;
+
+	if (option_value("pipe-size", argc, argv) != NULL) {
+		requested = atoi(option_value("pipe-size", argc, argv));
+		if (requested < 1) {
+			terminate("Invalid pipe size, use a number of bytes\n");
+		}
+	}
+
+	if (pipe(data) < 0 || pipe(acks) < 0) {
+		throw("Error opening pipes");
+	}
+
+	capacity = setup_pipe_size(data[1], requested, args.size);
+
+	if (side.gift) {
+		setup_gift(&side, capacity, args.size);
+		name_variant(&args, "-vmsplice");
+	}
+	if (side.sink) {
+		if ((side.sink_descriptor = open(SINK_PATH, O_WRONLY)) == -1) {
+			throw("Error opening " SINK_PATH);
+		}
+		name_variant(&args, "-splice");
+	}
+
+	communicate(&side, data, acks, &args);
+
+	if (side.sink) {
+		close(side.sink_descriptor);
+	}
+	free(side.messages);
+
+	return EXIT_SUCCESS;
+}
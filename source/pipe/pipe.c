@@ -4,6 +4,9 @@
 #include <unistd.h>
 
 #include "common/common.h"
+#include "common/results.h"
+#include "common/stream.h"
+#include "common/uring.h"
 
 FILE *open_stream(int file_descriptor[2], int to_open) {
 	FILE *stream;
@@ -24,6 +27,7 @@ FILE *open_stream(int file_descriptor[2], int to_open) {
 }
 
 void client_communicate(int file_descriptors[2], struct Arguments *args) {
+	int message;
 	struct sigaction signal_action;
 	FILE *stream;
 	void *buffer;
@@ -35,7 +39,7 @@ void client_communicate(int file_descriptors[2], struct Arguments *args) {
 	// Set things in motion
 	notify_server();
 
-	for (; args->count > 0; --args->count) {
+	for (message = total_messages(args); message > 0; --message) {
 		wait_for_signal(&signal_action);
 
 		if (fread(buffer, args->size, 1, stream) == -1) {
@@ -50,22 +54,35 @@ void client_communicate(int file_descriptors[2], struct Arguments *args) {
 	free(buffer);
 }
 
-void server_communicate(int file_descriptors[2], struct Arguments *args) {
+void server_communicate(int file_descriptors[2],
+												 struct Arguments *args,
+												 pid_t client) {
+	const int total = total_messages(args);
 	struct sigaction signal_action;
 	struct Benchmarks bench;
+	Results results;
 	FILE *stream;
 	void *buffer;
+	void *stream_buffer;
 	int message;
 
 	stream = open_stream(file_descriptors, 1);
 	setup_server_signals(&signal_action);
 	buffer = malloc(args->size);
 	setup_benchmarks(&bench);
+	benchmarks_count_peer(&bench, client);
+
+	// With a buffer of the message size, stdio writes every message with
+	// exactly one write(), so that the system calls can be counted
+	stream_buffer = malloc(args->size);
+	if (setvbuf(stream, stream_buffer, _IOFBF, args->size) != 0) {
+		throw("Error setting the stream buffer");
+	}
 
 	wait_for_signal(&signal_action);
 
-	for (message = 0; message < args->count; ++message) {
-		// bench.single_start = now();
+	for (message = total; message > 0; --message) {
+		bench.single_start = now();
 
 		if (fwrite(buffer, args->size, 1, stream) == -1) {
 			throw("Error writing to pipe");
@@ -75,13 +92,17 @@ void server_communicate(int file_descriptors[2], struct Arguments *args) {
 
 		notify_client();
 		wait_for_signal(&signal_action);
-		// benchmark(&bench);
+		benchmark(&bench);
 	}
 
-	evaluate(&bench, args);
+	summarize(&bench, args, &results);
+	// The write(), kill() and sigwait() of every message
+	results.syscalls = 3;
+	print_results(&results, args);
 
 	// Now close the write end too
-	close(file_descriptors[1]);
+	fclose(stream);
+	free(stream_buffer);
 	free(buffer);
 }
 
@@ -96,11 +117,82 @@ void communicate(int file_descriptors[2], struct Arguments *args) {
 
 	// fork() returns 0 for the child process
 	if (pid == (pid_t)0) {
+		pin_thread(args->client_cpu);
 		client_communicate(file_descriptors, args);
 	}
 
 	else {
-		server_communicate(file_descriptors, args);
+		pin_thread(args->server_cpu);
+		server_communicate(file_descriptors, args, pid);
+	}
+}
+
+void stream_messages(int file_descriptors[2], struct Arguments *args) {
+	Descriptors descriptors;
+	Channel channel;
+	int acks[2];
+	pid_t pid;
+
+	// Acknowledgements go back over a second pipe
+	if (pipe(acks) < 0) {
+		throw("Error opening pipe for acknowledgements");
+	}
+
+	if ((pid = fork()) == -1) {
+		throw("Error forking process");
+	}
+
+	if (pid == (pid_t)0) {
+		pin_thread(args->client_cpu);
+		close(file_descriptors[1]);
+		close(acks[0]);
+		descriptors.data = file_descriptors[0];
+		descriptors.ack = acks[1];
+		descriptor_channel(&channel, &descriptors);
+		stream_client(&channel, args);
+	} else {
+		pin_thread(args->server_cpu);
+		close(file_descriptors[0]);
+		close(acks[1]);
+		descriptors.data = file_descriptors[1];
+		descriptors.ack = acks[0];
+		descriptor_channel(&channel, &descriptors);
+		channel.peer = pid;
+		stream_server(&channel, args);
+	}
+
+	close(descriptors.data);
+	close(descriptors.ack);
+}
+
+void uring_messages(int file_descriptors[2], struct Arguments *args, int sqpoll) {
+	int replies[2];
+	pid_t pid;
+
+	// Unlike the signals of the plain ping-pong, the echo
+	// comes back over a second pipe
+	if (pipe(replies) < 0) {
+		throw("Error opening pipe for replies");
+	}
+
+	if ((pid = fork()) == -1) {
+		throw("Error forking process");
+	}
+
+	if (pid == (pid_t)0) {
+		pin_thread(args->client_cpu);
+		close(file_descriptors[1]);
+		close(replies[0]);
+		uring_client(file_descriptors[0], replies[1], args, sqpoll);
+		close(file_descriptors[0]);
+		close(replies[1]);
+	} else {
+		pin_thread(args->server_cpu);
+		close(file_descriptors[0]);
+		close(replies[1]);
+		uring_server(replies[0], file_descriptors[1], args, sqpoll);
+		close(file_descriptors[1]);
+		close(replies[0]);
 	}
 }
 
@@ -125,7 +217,16 @@ int main(int argc, char *argv[]) {
 		throw("Error opening pipe!\n");
 	}
 
-	communicate(file_descriptors, &args);
+	if (check_flag("uring", argc, argv) || check_flag("sqpoll", argc, argv)) {
+		// clang-format off
+		uring_messages(file_descriptors, &args,
+									 check_flag("sqpoll", argc, argv));
+		// clang-format on
+	} else if (args.mode == MODE_PINGPONG) {
+		communicate(file_descriptors, &args);
+	} else {
+		stream_messages(file_descriptors, &args);
+	}
 
 	return EXIT_SUCCESS;
 }
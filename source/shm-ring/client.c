@@ -0,0 +1,75 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/shm.h>
+
+#include "common/common.h"
+#include "common/stream.h"
+#include "shm-ring/shm-ring-common.h"
+
+void cleanup(char* shared_memory) {
+	// Detach the shared memory from this process' address space.
+	// The server removes the segment once both have detached.
+	shmdt(shared_memory);
+}
+
+void announce(Ring* ring) {
+	// An empty message tells the server we are attached
+	ring_write_slot(ring);
+	ring_publish(ring);
+}
+
+void pingpong(Ring rings[2], struct Arguments* args) {
+	int message;
+	void* buffer = malloc(args->size);
+
+	announce(&rings[CLIENT_RING]);
+
+	for (message = total_messages(args); message > 0; --message) {
+		// Read
+		memcpy(buffer, ring_read_slot(&rings[SERVER_RING]), args->size);
+		ring_release(&rings[SERVER_RING]);
+
+		// Write back
+		memset(ring_write_slot(&rings[CLIENT_RING]), '*', args->size);
+		ring_publish(&rings[CLIENT_RING]);
+	}
+
+	free(buffer);
+}
+
+void stream(Ring* ring, struct Arguments* args) {
+	int message;
+
+	announce(ring);
+
+	// Push as fast as the server lets us
+	for (message = total_messages(args); message > 0; --message) {
+		memset(ring_write_slot(ring), '*', args->size);
+		ring_publish(ring);
+	}
+}
+
+int main(int argc, char* argv[]) {
+	// The rings inside the shared memory
+	char* shared_memory;
+	Ring rings[2];
+
+	// Fetch command-line arguments
+	struct Arguments args;
+	parse_arguments(&args, argc, argv);
+	parse_ring_mode(&args, argc, argv);
+
+	shared_memory = attach_segment(create_segment(&args));
+	setup_rings(rings, shared_memory, &args);
+
+	if (args.mode == MODE_STREAM) {
+		stream(&rings[CLIENT_RING], &args);
+	} else {
+		pingpong(rings, &args);
+	}
+
+	cleanup(shared_memory);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/shm.h>
+
+#include "common/common.h"
+#include "common/stream.h"
+#include "shm-ring/shm-ring-common.h"
+
+void cleanup(int segment_id, char* shared_memory) {
+	// Detach the segment and schedule its removal
+	// once the client has detached as well
+	shmdt(shared_memory);
+	shmctl(segment_id, IPC_RMID, NULL);
+}
+
+void wait_for_client(Ring* ring) {
+	// The client announces itself with an empty message
+	ring_read_slot(ring);
+	ring_release(ring);
+}
+
+void pingpong(Ring rings[2], struct Arguments* args) {
+	struct Benchmarks bench;
+	int message;
+	void* buffer = malloc(args->size);
+
+	wait_for_client(&rings[CLIENT_RING]);
+	setup_benchmarks(&bench);
+
+	for (message = total_messages(args); message > 0; --message) {
+		bench.single_start = now();
+
+		// Write
+		memset(ring_write_slot(&rings[SERVER_RING]), '*', args->size);
+		ring_publish(&rings[SERVER_RING]);
+
+		// Read the response
+		memcpy(buffer, ring_read_slot(&rings[CLIENT_RING]), args->size);
+		ring_release(&rings[CLIENT_RING]);
+
+		benchmark(&bench);
+	}
+
+	evaluate(&bench, args);
+	free(buffer);
+}
+
+void stream(Ring* ring, struct Arguments* args) {
+	struct Benchmarks bench;
+	int message;
+	void* buffer = malloc(args->size);
+
+	wait_for_client(ring);
+	setup_benchmarks(&bench);
+
+	// In a stream there are no round trips, so a single
+	// benchmark is the time between two messages
+	bench.single_start = now();
+	for (message = total_messages(args); message > 0; --message) {
+		memcpy(buffer, ring_read_slot(ring), args->size);
+		ring_release(ring);
+
+		benchmark(&bench);
+		bench.single_start = now();
+	}
+
+	evaluate(&bench, args);
+	free(buffer);
+}
+
+int main(int argc, char* argv[]) {
+	// The identifier for the shared memory segment
+	int segment_id;
+
+	// The rings inside the shared memory
+	char* shared_memory;
+	Ring rings[2];
+
+	// Fetch command-line arguments
+	struct Arguments args;
+	parse_arguments(&args, argc, argv);
+	parse_ring_mode(&args, argc, argv);
+
+	segment_id = create_segment(&args);
+	shared_memory = attach_segment(segment_id);
+	setup_rings(rings, shared_memory, &args);
+
+	if (args.mode == MODE_STREAM) {
+		stream(&rings[CLIENT_RING], &args);
+	} else {
+		pingpong(rings, &args);
+	}
+
+	cleanup(segment_id, shared_memory);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,54 @@
+#include <sys/shm.h>
+
+#include "common/common.h"
+#include "common/stream.h"
+#include "shm-ring/shm-ring-common.h"
+
+static size_t segment_size(struct Arguments* args) {
+	return 2 * ring_memory_size(args->size, ring_slots(args->size));
+}
+
+int create_segment(struct Arguments* args) {
+	int segment_id;
+	key_t segment_key = generate_key("shm-ring");
+
+	// Whoever comes first creates the segment. It is zero-filled, which
+	// is a pair of empty rings, so neither side has to initialize it.
+	segment_id = shmget(segment_key, segment_size(args), IPC_CREAT | 0666);
+
+	if (segment_id < 0) {
+		throw("Error allocating segment");
+	}
+
+	return segment_id;
+}
+
+char* attach_segment(int segment_id) {
+	// Segments are attached at page boundaries,
+	// so the rings are aligned to cache lines
+	char* shared_memory = (char*)shmat(segment_id, NULL, 0);
+
+	if (shared_memory == (char*)-1) {
+		throw("Error attaching segment");
+	}
+
+	return shared_memory;
+}
+
+void setup_rings(Ring rings[2], char* shared_memory, struct Arguments* args) {
+	const int slots = ring_slots(args->size);
+	const size_t ring_size = ring_memory_size(args->size, slots);
+
+	ring_setup(&rings[SERVER_RING], shared_memory, args->size, slots);
+	ring_setup(&rings[CLIENT_RING], shared_memory + ring_size, args->size, slots);
+}
+
+void parse_ring_mode(struct Arguments* args, int argc, char* argv[]) {
+	if (check_flag("stream", argc, argv)) {
+		args->mode = MODE_STREAM;
+	}
+
+	if (args->mode != MODE_PINGPONG && args->mode != MODE_STREAM) {
+		terminate("shm-ring only supports --mode pingpong and stream\n");
+	}
+}
@@ -0,0 +1,22 @@
+#ifndef SHM_RING_COMMON_H
+#define SHM_RING_COMMON_H
+
+#include "common/ring.h"
+
+struct Arguments;
+
+// Messages from the server to the client (unused when streaming)
+#define SERVER_RING 0
+// Messages from the client to the server
+#define CLIENT_RING 1
+
+int create_segment(struct Arguments* args);
+
+char* attach_segment(int segment_id);
+
+void setup_rings(Ring rings[2], char* shared_memory, struct Arguments* args);
+
+// Accepts --mode pingpong or stream, and --stream for the latter
+void parse_ring_mode(struct Arguments* args, int argc, char* argv[]);
+
+#endif /* SHM_RING_COMMON_H */
@@ -15,28 +15,23 @@ void cleanup(void* shared_memory) {
 void communicate(void* shared_memory,
 								 struct Arguments* args,
 								 struct Sync* sync) {
+	int message;
+	void* payload = segment_message(shared_memory);
+
 	// Buffer into which to read data
 	void* buffer = malloc(args->size);
 
-	sync_notify(sync);
-
-	printf("4\n");
-
-	for (; args->count > 0; --args->count) {
-		sync_wait(sync);
+	sync_notify(sync, TURN_SERVER);
 
-		printf("5\n");
+	for (message = total_messages(args); message > 0; --message) {
+		sync_wait(sync, TURN_CLIENT);
 
 		// Read from memory
-		memcpy(buffer, shared_memory, args->size);
+		memcpy(buffer, payload, args->size);
 		// Write back
-		memset(shared_memory, '2', args->size);
+		memset(payload, '2', args->size);
 
-		printf("6\n");
-
-		sync_notify(sync);
-
-		printf("7\n");
+		sync_notify(sync, TURN_SERVER);
 	}
 
 	free(buffer);
@@ -58,9 +53,14 @@ int main(int argc, char* argv[]) {
 	struct Arguments args;
 	parse_arguments(&args, argc, argv);
 
+	// The server picks the method, but fail early on a typo here too,
+	// rather than waiting for a server that has already given up
+	parse_sync_method(argc, argv);
+
 	segment_id = create_segment(&args);
 	shared_memory = attach_segment(segment_id, &args);
-	sync = create_sync(shared_memory, &args);
+	sync = (struct Sync*)shared_memory;
+	wait_for_sync(sync);
 
 	communicate(shared_memory, &args, sync);
 
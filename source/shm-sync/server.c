@@ -6,7 +6,7 @@
 #include "common/common.h"
 #include "shm-sync-common.h"
 
-void cleanup(int segment_id, void* shared_memory, struct Sync* sync) {
+void cleanup(int segment_id, void* shared_memory) {
 	// Detach the shared memory from this process' address space.
 	// If this is the last process using this shared memory, it is removed.
 	shmdt(shared_memory);
@@ -22,7 +22,9 @@ void cleanup(int segment_id, void* shared_memory, struct Sync* sync) {
 	*/
 	shmctl(segment_id, IPC_RMID, NULL);
 
-	destroy_sync(sync);
+	// The synchronization objects are not destroyed: the client may
+	// still be returning from its last notification. They need no
+	// resources beyond the segment, which goes away with it.
 }
 
 
@@ -32,30 +34,23 @@ void communicate(void* shared_memory,
 	struct Benchmarks bench;
 	int message;
 	void* buffer = malloc(args->size);
+	void* payload = segment_message(shared_memory);
 
 	// Wait for signal from client
-	sync_wait(sync);
+	sync_wait(sync, TURN_SERVER);
 	setup_benchmarks(&bench);
 
-	for (message = 0; message < args->count; ++message) {
+	for (message = total_messages(args); message > 0; --message) {
 		bench.single_start = now();
 
-		printf("1\n");
-
 		// Write into the memory
-		memset(shared_memory, '1', args->size);
-
-		sync_notify(sync);
-		sync_wait(sync);
+		memset(payload, '1', args->size);
 
-		printf("2\n");
+		sync_notify(sync, TURN_CLIENT);
+		sync_wait(sync, TURN_SERVER);
 
 		// Read
-		memcpy(buffer, shared_memory, args->size);
-
-		sync_notify(sync);
-
-		printf("3\n");
+		memcpy(buffer, payload, args->size);
 
 		benchmark(&bench);
 	}
@@ -82,11 +77,12 @@ int main(int argc, char* argv[]) {
 
 	segment_id = create_segment(&args);
 	shared_memory = attach_segment(segment_id, &args);
-	sync = create_sync(shared_memory, &args);
+	sync = (struct Sync*)shared_memory;
+	init_sync(sync, argc, argv);
 
 	communicate(shared_memory, &args, sync);
 
-	cleanup(segment_id, shared_memory, sync);
+	cleanup(segment_id, shared_memory);
 
 	return EXIT_SUCCESS;
 }
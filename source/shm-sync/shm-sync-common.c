@@ -1,11 +1,26 @@
+#include <errno.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "common/arguments.h"
 #include "common/utility.h"
 #include "shm-sync-common.h"
 
+int parse_sync_method(int argc, char* argv[]) {
+	const char* method = option_value("sync", argc, argv);
 
-void init_sync(struct Sync* sync) {
+	if (method == NULL || strcmp(method, "condvar") == 0) {
+		return SYNC_CONDVAR;
+	} else if (strcmp(method, "futex") == 0) {
+		return SYNC_FUTEX;
+	} else if (strcmp(method, "semaphore") == 0) {
+		return SYNC_SEMAPHORE;
+	}
+
+	terminate("Unknown sync method, use one of condvar, futex, semaphore\n");
+}
+
+static void init_condition(struct Sync* sync, int robust) {
 	// These structures are used to initialize mutexes
 	// and condition variables. We will use them to set
 	// the PTHREAD_PROCESS_SHARED attribute, which enables
@@ -42,6 +57,13 @@ void init_sync(struct Sync* sync) {
 				&condition_attributes, PTHREAD_PROCESS_SHARED) != 0) {
 		throw("Error setting process-shared attribute for condition variable");
 	}
+
+	// A robust mutex is handed to the next locker with EOWNERDEAD
+	// if its owner dies, instead of blocking it forever
+	if (robust && pthread_mutexattr_setrobust(
+				&mutex_attributes, PTHREAD_MUTEX_ROBUST) != 0) {
+		throw("Error setting robust attribute for mutex");
+	}
 	// clang-format on
 
 	// Initialize the mutex and condition variable and pass the attributes
@@ -61,56 +83,122 @@ void init_sync(struct Sync* sync) {
 	}
 }
 
-void destroy_sync(struct Sync* sync) {
-	if (pthread_mutex_destroy(&sync->mutex)) {
-		throw("Error destroying mutex");
+static void init_semaphores(struct Sync* sync) {
+	int index;
+
+	// A non-zero second argument shares the semaphore between processes,
+	// which requires it to live in shared memory (as it does here)
+	for (index = 0; index < 2; ++index) {
+		if (sem_init(&sync->semaphores[index], 1, 0) == -1) {
+			throw("Error initializing semaphore");
+		}
 	}
-	if (pthread_cond_destroy(&sync->condition)) {
-		throw("Error destroying condition variable");
+}
+
+void init_sync(struct Sync* sync, int argc, char* argv[]) {
+	sync->method = parse_sync_method(argc, argv);
+	sync->turn = TURN_NONE;
+	atomic_store(&sync->guard.token, TURN_NONE);
+	atomic_store(&sync->guard.sleepers, 0);
+
+	switch (sync->method) {
+		case SYNC_CONDVAR:
+			init_condition(sync, check_flag("robust", argc, argv));
+			break;
+		case SYNC_SEMAPHORE: init_semaphores(sync); break;
+		default: break;
 	}
+
+	// Publishes the initialized objects to the client
+	atomic_store(&sync->ready, 1);
 }
 
-void sync_wait(struct Sync* sync) {
-	// Lock the mutex
-	if (pthread_mutex_lock(&sync->mutex) != 0) {
+void wait_for_sync(struct Sync* sync) {
+	// The client may attach before the server has set up the segment
+	while (!atomic_load(&sync->ready)) {
+		usleep(100);
+	}
+}
+
+static void lock(struct Sync* sync, int result) {
+	// The peer died while holding the mutex. We could restore the
+	// state it protects, but without a peer there is nothing to measure.
+	if (result == EOWNERDEAD) {
+		pthread_mutex_consistent(&sync->mutex);
+		pthread_mutex_unlock(&sync->mutex);
+		terminate("Peer died while holding the mutex\n");
+	} else if (result != 0) {
 		throw("Error locking mutex");
 	}
+}
 
-	// Move into waiting for the condition variable to be signalled.
-	// For this, it is essential that the mutex first be locked (above)
-	// to avoid data races on the condition variable (e.g. the signal
-	// being sent before the waiting process has begun). In fact, behaviour
-	// is undefined otherwise. Once the mutex has begun waiting, the mutex
-	// is unlocked so that other threads may do something and eventually
-	// signal the condition variable. At that point, this thread wakes up
-	// and *re-acquires* the lock immediately. As such, when this method
-	// returns the lock will be owned by the calling thread.
-	if (pthread_cond_wait(&sync->condition, &sync->mutex) != 0) {
-		throw("Error waiting for condition variable");
+static void condition_wait(struct Sync* sync, int turn) {
+	lock(sync, pthread_mutex_lock(&sync->mutex));
+
+	// Waiting for the condition variable unlocks the mutex, so that the
+	// peer can change the turn and signal us, and locks it again before
+	// returning. The predicate is checked under the mutex: if the peer
+	// signalled before we started waiting, the turn is already ours and
+	// we must not wait at all. The loop also covers spurious wakeups.
+	while (sync->turn != turn) {
+		lock(sync, pthread_cond_wait(&sync->condition, &sync->mutex));
+	}
+
+	if (pthread_mutex_unlock(&sync->mutex) != 0) {
+		throw("Error unlocking mutex");
 	}
 }
 
-void sync_notify(struct Sync* sync) {
-	// Signals to a single thread waiting on the condition variable
-	// to wake up, if any such thread exists. An alternative would be
-	// to call pthread_cond_broadcast, in which case *all* waiting
-	// threads would be woken up.
+static void condition_notify(struct Sync* sync, int turn) {
+	lock(sync, pthread_mutex_lock(&sync->mutex));
+
+	sync->turn = turn;
+
+	// Wakes a single process waiting on the condition variable, if any.
+	// Only the peer can be waiting, so there is no need to broadcast.
 	if (pthread_cond_signal(&sync->condition) != 0) {
 		throw("Error signalling condition variable");
 	}
+
+	if (pthread_mutex_unlock(&sync->mutex) != 0) {
+		throw("Error unlocking mutex");
+	}
 }
 
-#include <stdio.h>
+void sync_wait(struct Sync* sync, int turn) {
+	switch (sync->method) {
+		case SYNC_FUTEX: guard_sleep(&sync->guard, turn); break;
+		case SYNC_SEMAPHORE:
+			// The semaphore counts the posts, so none can be missed
+			while (sem_wait(&sync->semaphores[turn - 1]) == -1) {
+				if (errno != EINTR) throw("Error waiting for semaphore");
+			}
+			break;
+		default: condition_wait(sync, turn);
+	}
+}
+
+void sync_notify(struct Sync* sync, int turn) {
+	switch (sync->method) {
+		case SYNC_FUTEX: guard_notify(&sync->guard, turn); break;
+		case SYNC_SEMAPHORE:
+			if (sem_post(&sync->semaphores[turn - 1]) == -1) {
+				throw("Error posting semaphore");
+			}
+			break;
+		default: condition_notify(sync, turn);
+	}
+}
 
 int create_segment(struct Arguments* args) {
 	// The identifier for the shared memory segment
 	int segment_id;
 
 	// Key for the memory segment
-	key_t segment_key = generate_key("shm");
+	key_t segment_key = generate_key("shm-sync");
 
 	// The size for the segment
-	int size = args->size + sizeof(*(struct Sync*)0);
+	int size = sizeof(struct Sync) + args->size;
 
 	/*
 		The call that actually allocates the shared memory segment.
@@ -159,18 +247,14 @@ shared memory. Children processes created with fork() inherit this segment.
 */
 	shared_memory = shmat(segment_id, NULL, 0);
 
-	if (shared_memory < 0) {
+	if (shared_memory == (void*)-1) {
 		throw("Could not attach segment");
 	}
 
-	memset(shared_memory, 0, args->size);
-
 	return shared_memory;
 }
 
-struct Sync* create_sync(void* shared_memory, struct Arguments* args) {
-	struct Sync* sync = (struct Sync*)shared_memory + args->size;
-	init_sync(sync);
-
-	return sync;
+void* segment_message(void* shared_memory) {
+	// In bytes, the Sync is a multiple of the cache line size
+	return (char*)shared_memory + sizeof(struct Sync);
 }
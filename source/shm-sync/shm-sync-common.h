@@ -2,28 +2,58 @@
 #define SHM_SYNC_COMMON_H
 
 #include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
 #include <sys/shm.h>
 
+#include "common/guard.h"
+
 struct Arguments;
 
+// How the two processes hand over the turn (--sync=<method>)
+enum SyncMethod { SYNC_CONDVAR, SYNC_FUTEX, SYNC_SEMAPHORE };
+
+// Whose turn it is to access the message
+enum Turn { TURN_NONE, TURN_SERVER, TURN_CLIENT };
+
+// Lives at the start of the segment, the message follows on its own
+// cache line. Only the server initializes it, the client waits for ready.
 struct Sync {
+	// The futex word (for SYNC_FUTEX), also fills the first cache line
+	Guard guard;
+
+	// Set by the server once everything below is initialized
+	atomic_int ready;
+
+	// The SyncMethod chosen by the server
+	int method;
+
+	// The predicate of the condition variable, protected by the mutex
+	int turn;
 	pthread_mutex_t mutex;
 	pthread_cond_t condition;
+
+	// One semaphore per turn, posted to hand it over
+	sem_t semaphores[2];
 };
 
-void init_sync(struct Sync* sync);
+// The SyncMethod given by --sync=<method> (condvar by default)
+int parse_sync_method(int argc, char* argv[]);
+
+void init_sync(struct Sync* sync, int argc, char* argv[]);
 
-void destroy_sync(struct Sync* sync);
+void wait_for_sync(struct Sync* sync);
 
-void sync_wait(struct Sync* sync);
+void sync_wait(struct Sync* sync, int turn);
 
-void sync_notify(struct Sync* sync);
+void sync_notify(struct Sync* sync, int turn);
 
 
 int create_segment(struct Arguments* args);
 
 void* attach_segment(int segment_id, struct Arguments* args);
 
-struct Sync* create_sync(void* shared_memory, struct Arguments* args);
+// The message in the segment, following the Sync
+void* segment_message(void* shared_memory);
 
 #endif /* SHM_SYNC_COMMON_H */
@@ -1,6 +1,4 @@
-#include <assert.h>
 #include <signal.h>
-#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -8,6 +6,8 @@
 #include <unistd.h>
 
 #include "common/common.h"
+#include "common/guard.h"
+#include "common/stream.h"
 
 void cleanup(char* shared_memory) {
 	// Detach the shared memory from this process' address space.
@@ -15,30 +15,33 @@ void cleanup(char* shared_memory) {
 	shmdt(shared_memory);
 }
 
-void shm_wait(atomic_char* guard) {
-	while (atomic_load(guard) != 'c')
-		;
+void shm_wait(Guard* guard, struct Arguments* args) {
+	guard_wait(guard, 'c', args);
 }
 
-void shm_notify(atomic_char* guard) {
-	atomic_store(guard, 's');
+void shm_notify(Guard* guard) {
+	guard_notify(guard, 's');
 }
 
 void communicate(char* shared_memory, struct Arguments* args) {
+	int message;
+
 	// Buffer into which to read data
 	void* buffer = malloc(args->size);
 
-	atomic_char* guard = (atomic_char*)shared_memory;
-	atomic_init(guard, 's');
-	assert(sizeof(atomic_char) == 1);
+	Guard* guard = (Guard*)shared_memory;
+	char* payload = shared_memory + sizeof(Guard);
+
+	// Tell the server we can go
+	shm_notify(guard);
 
-	for (; args->count > 0; --args->count) {
-		shm_wait(guard);
+	for (message = total_messages(args); message > 0; --message) {
+		shm_wait(guard, args);
 		// Read
-		memcpy(buffer, shared_memory + 1, args->size);
+		memcpy(buffer, payload, args->size);
 
 		// Write back
-		memset(shared_memory + 1, '*', args->size);
+		memset(payload, '*', args->size);
 
 		shm_notify(guard);
 	}
@@ -46,6 +49,19 @@ void communicate(char* shared_memory, struct Arguments* args) {
 	free(buffer);
 }
 
+void stream_messages(char* shared_memory, struct Arguments* args) {
+	Guard* guard = (Guard*)shared_memory;
+	RingChannel ring;
+	Channel channel;
+
+	// Wait until the server has set up the ring
+	shm_wait(guard, args);
+	ring_channel(&channel, &ring, shared_memory + sizeof(Guard), args->size);
+	shm_notify(guard);
+
+	stream_client(&channel, args);
+}
+
 int main(int argc, char* argv[]) {
 	// The identifier for the shared memory segment
 	int segment_id;
@@ -78,7 +94,7 @@ int main(int argc, char* argv[]) {
 		The call will return the segment ID if the key was valid,
 		else the call fails.
 	*/
-	segment_id = shmget(segment_key, 1 + args.size, IPC_CREAT | 0666);
+	segment_id = shmget(segment_key, sizeof(Guard) + message_memory_size(&args), IPC_CREAT | 0666);
 
 	if (segment_id < 0) {
 		throw("Could not get segment");
@@ -107,7 +123,11 @@ int main(int argc, char* argv[]) {
 		throw("Could not attach segment");
 	}
 
-	communicate(shared_memory, &args);
+	if (args.mode == MODE_PINGPONG) {
+		communicate(shared_memory, &args);
+	} else {
+		stream_messages(shared_memory, &args);
+	}
 
 	cleanup(shared_memory);
 
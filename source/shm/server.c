@@ -1,5 +1,4 @@
 #include <signal.h>
-#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -7,6 +6,8 @@
 #include <unistd.h>
 
 #include "common/common.h"
+#include "common/guard.h"
+#include "common/stream.h"
 
 void cleanup(int segment_id, char* shared_memory) {
 	// Detach the shared memory from this process' address space.
@@ -25,36 +26,36 @@ void cleanup(int segment_id, char* shared_memory) {
 	shmctl(segment_id, IPC_RMID, NULL);
 }
 
-void shm_wait(atomic_char* guard) {
-	while (atomic_load(guard) != 's')
-		;
+void shm_wait(Guard* guard, struct Arguments* args) {
+	guard_wait(guard, 's', args);
 }
 
-void shm_notify(atomic_char* guard) {
-	atomic_store(guard, 'c');
+void shm_notify(Guard* guard) {
+	guard_notify(guard, 'c');
 }
 
 void communicate(char* shared_memory, struct Arguments* args) {
 	struct Benchmarks bench;
 	int message;
 	void* buffer = malloc(args->size);
-	atomic_char* guard = (atomic_char*)shared_memory;
+	Guard* guard = (Guard*)shared_memory;
+	char* payload = shared_memory + sizeof(Guard);
 
 	// Wait for signal from client
-	shm_wait(guard);
+	shm_wait(guard, args);
 	setup_benchmarks(&bench);
 
-	for (message = 0; message < args->count; ++message) {
+	for (message = total_messages(args); message > 0; --message) {
 		bench.single_start = now();
 
 		// Write
-		memset(shared_memory + 1, '*', args->size);
+		memset(payload, '*', args->size);
 
 		shm_notify(guard);
-		shm_wait(guard);
+		shm_wait(guard, args);
 
 		// Read
-		memcpy(buffer, shared_memory + 1, args->size);
+		memcpy(buffer, payload, args->size);
 
 		benchmark(&bench);
 	}
@@ -63,6 +64,22 @@ void communicate(char* shared_memory, struct Arguments* args) {
 	free(buffer);
 }
 
+void stream_messages(char* shared_memory, struct Arguments* args) {
+	Guard* guard = (Guard*)shared_memory;
+	RingChannel ring;
+	Channel channel;
+
+	// The memory may be left over from an earlier run
+	memset(shared_memory + sizeof(Guard), 0, ring_channel_size(args->size));
+	ring_channel(&channel, &ring, shared_memory + sizeof(Guard), args->size);
+
+	// Tell the client the ring is ready, then wait for it
+	shm_notify(guard);
+	shm_wait(guard, args);
+
+	stream_server(&channel, args);
+}
+
 int main(int argc, char* argv[]) {
 	// The identifier for the shared memory segment
 	int segment_id;
@@ -98,7 +115,7 @@ int main(int argc, char* argv[]) {
 			- Use `ipcs -m` to show shared memory segments and their IDs
 			- Use `ipcrm -m <segment_id>` to remove/deallocate a shared memory segment
 	*/
-	segment_id = shmget(segment_key, 1 + args.size, IPC_CREAT | 0666);
+	segment_id = shmget(segment_key, sizeof(Guard) + message_memory_size(&args), IPC_CREAT | 0666);
 
 	if (segment_id < 0) {
 		throw("Error allocating segment");
@@ -127,7 +144,11 @@ int main(int argc, char* argv[]) {
 		throw("Error attaching segment");
 	}
 
-	communicate(shared_memory, &args);
+	if (args.mode == MODE_PINGPONG) {
+		communicate(shared_memory, &args);
+	} else {
+		stream_messages(shared_memory, &args);
+	}
 
 	cleanup(segment_id, shared_memory);
 
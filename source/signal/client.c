@@ -3,10 +3,12 @@
 #include "common/common.h"
 
 void communicate(struct sigaction* signal_action, struct Arguments* args) {
+	int message;
+
 	// Tell the sever we can go
 	notify_server();
 
-	for (; args->count > 0; --args->size) {
+	for (message = total_messages(args); message > 0; --message) {
 		wait_for_signal(signal_action);
 		notify_server();
 	}
@@ -9,13 +9,13 @@ void communicate(struct sigaction* signal_action, struct Arguments* args) {
 	wait_for_signal(signal_action);
 	setup_benchmarks(&bench);
 
-	for (message = 0; message < args->count; ++message) {
-		// bench.single_start = now();
+	for (message = total_messages(args); message > 0; --message) {
+		bench.single_start = now();
 
 		notify_client();
 		wait_for_signal(signal_action);
 
-		// benchmark(&bench);
+		benchmark(&bench);
 	}
 
 	// "Ignore" the size
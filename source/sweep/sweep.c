@@ -0,0 +1,324 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "common/signals.h"
+#include "common/topology.h"
+#include "common/utility.h"
+
+#define MAX_TRANSPORTS 32
+#define MAX_COLUMNS 64
+#define LINE_SIZE 4096
+
+// The relations we look for a representative pair of CPUs for
+static const CpuRelation relations[] = {RELATION_SAME_CPU,
+																				RELATION_SMT_SIBLING,
+																				RELATION_SAME_LLC,
+																				RELATION_SAME_SOCKET,
+																				RELATION_CROSS_SOCKET,
+																				RELATION_CROSS_NUMA};
+
+#define RELATIONS (int)(sizeof relations / sizeof relations[0])
+
+typedef struct Pair {
+	int server_cpu;
+	int client_cpu;
+} Pair;
+
+typedef struct Cell {
+	// Zero if the run failed or there is no pair for the relation
+	int valid;
+	double p50;
+	double p99;
+} Cell;
+
+void print_sweep_usage() {
+	printf(
+			"Usage: sweep <transport>... [-- <transport options>]\n"
+			"Runs every transport once per CPU relation and prints the\n"
+			"median and 99th percentile latency (in us) as a matrix.\n");
+	exit(EXIT_FAILURE);
+}
+
+void find_pairs(Pair pairs[RELATIONS]) {
+	int first = -1;
+	int cpu;
+	int index;
+	CpuRelation relation;
+
+	for (index = 0; index < RELATIONS; ++index) {
+		pairs[index].server_cpu = -1;
+		pairs[index].client_cpu = -1;
+	}
+
+	// Relate the first CPU we may use to all others, which finds
+	// one pair for every relation the machine has to offer
+	for (cpu = 0; cpu < sysconf(_SC_NPROCESSORS_CONF); ++cpu) {
+		if (!cpu_allowed(cpu)) continue;
+		if (first == -1) first = cpu;
+
+		relation = cpu_relation(first, cpu);
+		for (index = 0; index < RELATIONS; ++index) {
+			if (relations[index] == relation && pairs[index].server_cpu == -1) {
+				pairs[index].server_cpu = first;
+				pairs[index].client_cpu = cpu;
+			}
+		}
+	}
+}
+
+void find_transport(char* path, size_t size, const char* transport) {
+	char directory[LINE_SIZE];
+	size_t prefix;
+
+	// The transports are built next to the sweep directory
+	executable_directory(directory, sizeof directory);
+	*strrchr(directory, '/') = '\0';
+
+	// Most transports have a directory of their own (shm, shm-sync), the
+	// others share one with their variants (eventfd-bi in eventfd)
+	snprintf(path, size, "%s/%s/%s", directory, transport, transport);
+	if (access(path, X_OK) == 0) return;
+
+	prefix = strcspn(transport, "-");
+	snprintf(path,
+					 size,
+					 "%s/%.*s/%s",
+					 directory,
+					 (int)prefix,
+					 transport,
+					 transport);
+	if (access(path, X_OK) == 0) return;
+
+	fprintf(stderr, "Could not find transport '%s'\n", transport);
+	exit(EXIT_FAILURE);
+}
+
+// Splits a CSV line in place, returns the number of fields
+int split_csv(char* line, char* fields[MAX_COLUMNS]) {
+	int count = 0;
+	int quoted = 0;
+	char* read = line;
+	char* write = line;
+
+	fields[count++] = write;
+	for (; *read != '\0' && *read != '\n'; ++read) {
+		if (*read == '"') {
+			// A doubled quote inside a quoted field is a literal quote
+			if (quoted && read[1] == '"') {
+				*write++ = *++read;
+			} else {
+				quoted = !quoted;
+			}
+		} else if (*read == ',' && !quoted && count < MAX_COLUMNS) {
+			*write++ = '\0';
+			fields[count++] = write;
+		} else {
+			*write++ = *read;
+		}
+	}
+	*write = '\0';
+
+	return count;
+}
+
+int find_column(char* header[], int columns, const char* name) {
+	int index;
+
+	for (index = 0; index < columns; ++index) {
+		if (strcmp(header[index], name) == 0) return index;
+	}
+
+	return -1;
+}
+
+void parse_results(FILE* stream, Cell* cell) {
+	char header_line[LINE_SIZE];
+	char value_line[LINE_SIZE];
+	char* header[MAX_COLUMNS];
+	char* values[MAX_COLUMNS];
+	int columns;
+	int p50, p99;
+
+	// The CSV format is a header row followed by a value row
+	if (fgets(header_line, sizeof header_line, stream) == NULL) return;
+	if (fgets(value_line, sizeof value_line, stream) == NULL) return;
+
+	columns = split_csv(header_line, header);
+	if (split_csv(value_line, values) != columns) return;
+
+	p50 = find_column(header, columns, "p50_ns");
+	p99 = find_column(header, columns, "p99_ns");
+	if (p50 == -1 || p99 == -1 || *values[p50] == '\0') return;
+
+	cell->p50 = atof(values[p50]) / 1000.0;
+	cell->p99 = atof(values[p99]) / 1000.0;
+	cell->valid = 1;
+}
+
+void run(const char* path, const Pair* pair, int argc, char* argv[], Cell* cell) {
+	char server_cpu[16];
+	char client_cpu[16];
+	char* arguments[argc + 8];
+	int file_descriptors[2];
+	int status;
+	pid_t pid;
+	FILE* stream;
+	int index;
+
+	snprintf(server_cpu, sizeof server_cpu, "%d", pair->server_cpu);
+	snprintf(client_cpu, sizeof client_cpu, "%d", pair->client_cpu);
+
+	arguments[0] = (char*)path;
+	for (index = 0; index < argc; ++index) {
+		arguments[index + 1] = argv[index];
+	}
+	index = argc + 1;
+	arguments[index++] = "--format";
+	arguments[index++] = "csv";
+	arguments[index++] = "--server-cpu";
+	arguments[index++] = server_cpu;
+	arguments[index++] = "--client-cpu";
+	arguments[index++] = client_cpu;
+	arguments[index] = NULL;
+
+	if (pipe(file_descriptors) == -1) {
+		throw("Error creating pipe");
+	}
+
+	if ((pid = fork()) == -1) {
+		throw("Error forking process");
+	}
+
+	if (pid == 0) {
+		// The transports signal their whole process group,
+		// so every run gets a group of its own
+		if (setpgid(0, 0) == -1) {
+			throw("Error creating process group");
+		}
+		close(file_descriptors[0]);
+		if (dup2(file_descriptors[1], STDOUT_FILENO) == -1) {
+			throw("Error redirecting output");
+		}
+		execv(path, arguments);
+		throw("Error starting transport");
+	}
+
+	close(file_descriptors[1]);
+	if ((stream = fdopen(file_descriptors[0], "r")) == NULL) {
+		throw("Error opening pipe");
+	}
+
+	cell->valid = 0;
+	parse_results(stream, cell);
+	fclose(stream);
+
+	if (waitpid(pid, &status, 0) == -1) {
+		throw("Error waiting for transport");
+	}
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+		cell->valid = 0;
+	}
+}
+
+void print_matrix(char* transports[],
+									int count,
+									const Pair pairs[RELATIONS],
+									Cell cells[][RELATIONS]) {
+	char cell[32];
+	int transport;
+	int index;
+
+	printf("\n%-16s", "p50/p99 (us)");
+	for (index = 0; index < RELATIONS; ++index) {
+		printf("%18s", relation_name(relations[index]));
+	}
+
+	printf("\n%-16s", "cpus");
+	for (index = 0; index < RELATIONS; ++index) {
+		if (pairs[index].server_cpu == -1) {
+			printf("%18s", "-");
+		} else {
+			// clang-format off
+			snprintf(cell, sizeof cell, "%d <-> %d",
+							 pairs[index].server_cpu, pairs[index].client_cpu);
+			// clang-format on
+			printf("%18s", cell);
+		}
+	}
+	printf("\n");
+
+	for (transport = 0; transport < count; ++transport) {
+		printf("%-16s", transports[transport]);
+		for (index = 0; index < RELATIONS; ++index) {
+			if (pairs[index].server_cpu == -1) {
+				printf("%18s", "n/a");
+			} else if (!cells[transport][index].valid) {
+				printf("%18s", "failed");
+			} else {
+				// clang-format off
+				snprintf(cell, sizeof cell, "%.2f/%.2f",
+								 cells[transport][index].p50, cells[transport][index].p99);
+				// clang-format on
+				printf("%18s", cell);
+			}
+		}
+		printf("\n");
+	}
+}
+
+int main(int argc, char* argv[]) {
+	char* transports[MAX_TRANSPORTS];
+	char path[LINE_SIZE];
+	Pair pairs[RELATIONS];
+	Cell cells[MAX_TRANSPORTS][RELATIONS];
+	int count = 0;
+	int options;
+	int transport;
+	int index;
+
+	// Transports come first, anything after "--" is passed on to them
+	for (options = 1; options < argc; ++options) {
+		if (strcmp(argv[options], "--") == 0) {
+			++options;
+			break;
+		}
+		if (count == MAX_TRANSPORTS || argv[options][0] == '-') {
+			print_sweep_usage();
+		}
+		transports[count++] = argv[options];
+	}
+	if (count == 0) print_sweep_usage();
+
+	// Stray signals of the transports must not kill us
+	setup_parent_signals();
+
+	find_pairs(pairs);
+
+	for (transport = 0; transport < count; ++transport) {
+		find_transport(path, sizeof path, transports[transport]);
+
+		for (index = 0; index < RELATIONS; ++index) {
+			if (pairs[index].server_cpu == -1) continue;
+
+			fprintf(stderr,
+							"Running %s on CPUs %d and %d (%s)\n",
+							transports[transport],
+							pairs[index].server_cpu,
+							pairs[index].client_cpu,
+							relation_name(relations[index]));
+
+			// clang-format off
+			run(path, &pairs[index], argc - options, argv + options,
+					&cells[transport][index]);
+			// clang-format on
+		}
+	}
+
+	print_matrix(transports, count, pairs, cells);
+
+	return EXIT_SUCCESS;
+}
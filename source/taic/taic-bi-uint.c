@@ -1,3 +1,4 @@
+#define _GNU_SOURCE
 #include <pthread.h>
 #include <sched.h>
 #include <stdint.h>
@@ -28,18 +29,16 @@ volatile unsigned long has_received[2];
 struct Benchmarks bench;
 
 void server_uintr_handler(struct __uintr_frame* ui_frame) {
-	volatile uint64_t data = lq_deq(server_lq_base);
-	// received notification
-	// assert(data == handler);
+	// Take the notification off the queue, it can only be the handler
+	(void)lq_deq(server_lq_base);
 	lq_register_receiver(server_lq_base, client_os, client_proc, handler);
 	is_inited[0] = 1;
 	has_received[0] = 1;
 }
 
 void client_uintr_handler(struct __uintr_frame* ui_frame) {
-	volatile uint64_t data = lq_deq(client_lq_base);
-	// received notification
-	// assert(data == handler);
+	// Take the notification off the queue, it can only be the handler
+	(void)lq_deq(client_lq_base);
 	lq_register_receiver(client_lq_base, server_os, server_proc, handler);
 	is_inited[1] = 1;
 	has_received[1] = 1;
@@ -62,8 +61,14 @@ void notify(unsigned int token, uint64_t lq_base) {
 	}
 }
 
+// The client thread, whose CPU usage is reported next to the server's
+volatile pid_t client_thread = 0;
+
 void *client_communicate(void *arg) {
 	struct Arguments* args = (struct Arguments*)arg;
+	client_thread = gettid();
+	pin_thread(args->client_cpu);
+
 	int mem_fd;
 	void* taic_base = get_taic(&mem_fd);
 	client_lq_base = alloc_lq(taic_base, client_os, client_proc);
@@ -73,7 +78,7 @@ void *client_communicate(void *arg) {
 	is_inited[CLIENT_TOKEN] = 1;
 	has_received[CLIENT_TOKEN] = 0;
 	int loop;
-	for (loop = args->count; loop > 0; --loop) {
+	for (loop = total_messages(args); loop > 0; --loop) {
 		wait(CLIENT_TOKEN, client_lq_base);
 		notify(SERVER_TOKEN, client_lq_base);
 	}
@@ -85,6 +90,8 @@ void *client_communicate(void *arg) {
 }
 
 void server_communicate(struct Arguments* args) {
+	pin_thread(args->server_cpu);
+
 	int mem_fd;
 	void* taic_base = get_taic(&mem_fd);
 	server_lq_base = alloc_lq(taic_base, server_os, server_proc);
@@ -93,12 +100,20 @@ void server_communicate(struct Arguments* args) {
 	lq_register_receiver(server_lq_base, client_os, client_proc, handler);
 	is_inited[SERVER_TOKEN] = 1;
 	has_received[SERVER_TOKEN] = 0;
+	// The client thread publishes itself once it runs
+	while (client_thread == 0)
+		;
 	setup_benchmarks(&bench);
+	benchmarks_count_peer(&bench, client_thread);
 
 	int message;
-	for (message = 0; message < args->count; ++message) {
+	for (message = total_messages(args); message > 0; --message) {
+		bench.single_start = now();
+
 		notify(CLIENT_TOKEN, server_lq_base);
 		wait(SERVER_TOKEN, server_lq_base);
+
+		benchmark(&bench);
 	}
 
 	// The message size is always one (it's just a signal)
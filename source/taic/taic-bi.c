@@ -1,3 +1,4 @@
+#define _GNU_SOURCE
 #include <pthread.h>
 #include <sched.h>
 #include <stdint.h>
@@ -51,8 +52,14 @@ void notify(unsigned int token, uint64_t lq_base) {
 	}
 }
 
+// The client thread, whose CPU usage is reported next to the server's
+volatile pid_t client_thread = 0;
+
 void *client_communicate(void *arg) {
 	struct Arguments* args = (struct Arguments*)arg;
+	client_thread = gettid();
+	pin_thread(args->client_cpu);
+
 	int mem_fd;
 	void* taic_base = get_taic(&mem_fd);
 	uint64_t lq_base = alloc_lq(taic_base, client_os, client_proc);
@@ -60,7 +67,7 @@ void *client_communicate(void *arg) {
 	lq_register_receiver(lq_base, server_os, server_proc, handler);
 	is_inited[CLIENT_TOKEN] = 1;
 	int loop;
-	for (loop = args->count; loop > 0; --loop) {
+	for (loop = total_messages(args); loop > 0; --loop) {
 		wait(CLIENT_TOKEN, lq_base);
 		notify(SERVER_TOKEN, lq_base);
 	}
@@ -72,18 +79,28 @@ void *client_communicate(void *arg) {
 }
 
 void server_communicate(struct Arguments* args) {
+	pin_thread(args->server_cpu);
+
 	int mem_fd;
 	void* taic_base = get_taic(&mem_fd);
 	uint64_t lq_base = alloc_lq(taic_base, server_os, server_proc);
 	lq_register_sender(lq_base, client_os, client_proc);
 	lq_register_receiver(lq_base, client_os, client_proc, handler);
 	is_inited[SERVER_TOKEN] = 1;
+	// The client thread publishes itself once it runs
+	while (client_thread == 0)
+		;
 	setup_benchmarks(&bench);
+	benchmarks_count_peer(&bench, client_thread);
 
 	int message;
-	for (message = 0; message < args->count; ++message) {
+	for (message = total_messages(args); message > 0; --message) {
+		bench.single_start = now();
+
 		notify(CLIENT_TOKEN, lq_base);
 		wait(SERVER_TOKEN, lq_base);
+
+		benchmark(&bench);
 	}
 
 	// The message size is always one (it's just a signal)
@@ -0,0 +1,374 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <signal.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "common/utility.h"
+#include "taic-emu.h"
+
+// Stands in for the user software interrupt of the board
+#define TAIC_EMU_SIGNAL SIGRTMIN
+
+// Someone a local queue sends interrupts to or accepts them from, named by
+// the (os, process) pair that allocated the other local queue
+typedef struct Registration {
+	uint64_t os;
+	uint64_t proc;
+	// Receivers: the value enqueued for an interrupt
+	uint64_t handler;
+	// Receivers: accepts one interrupt, until registered again
+	atomic_int armed;
+} Registration;
+
+typedef struct Slot {
+	atomic_size_t sequence;
+	uint64_t value;
+} Slot;
+
+// A local queue is a bounded multi-producer multi-consumer queue in the
+// style of Dmitry Vyukov's (like mpsc in ipc-bench) plus the registrations
+// the controller checks when forwarding an interrupt
+typedef struct LocalQueue {
+	alignas(CACHE_LINE) atomic_int allocated;
+	uint64_t os;
+	uint64_t proc;
+
+	// The thread to signal for an interrupt (0 = it polls)
+	atomic_int process;
+	atomic_int thread;
+
+	alignas(CACHE_LINE) atomic_size_t enqueue;
+	alignas(CACHE_LINE) atomic_size_t dequeue;
+	alignas(CACHE_LINE) Slot slots[TAIC_EMU_SLOTS];
+
+	// Written by the owner only, readers see up to the published count
+	Registration senders[TAIC_EMU_REGISTRATIONS];
+	Registration receivers[TAIC_EMU_REGISTRATIONS];
+	atomic_int sender_count;
+	atomic_int receiver_count;
+} LocalQueue;
+
+typedef struct Taic {
+	LocalQueue queues[TAIC_EMU_QUEUES];
+} Taic;
+
+// One controller per process, in shared memory so that it survives fork()
+static Taic* taic;
+static int taic_users;
+static pthread_mutex_t taic_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// The local queue the calling thread enabled interrupts for and its handler
+static __thread LocalQueue* interrupted_queue;
+static __thread void (*interrupt_handler)(struct __uintr_frame*);
+
+void* get_taic(int* mem_fd) {
+	pthread_mutex_lock(&taic_lock);
+	if (taic_users++ == 0) {
+		// Anonymous memory is zero-filled, i.e. all queues are free
+		// clang-format off
+		taic = mmap(NULL, sizeof(Taic), PROT_READ | PROT_WRITE,
+								MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+		// clang-format on
+		if (taic == MAP_FAILED) {
+			throw("Error mapping emulated TAIC");
+		}
+	}
+	pthread_mutex_unlock(&taic_lock);
+
+	// There is no /dev/mem to close
+	*mem_fd = -1;
+
+	return taic;
+}
+
+void free_taic(void* taic_base, int* mem_fd) {
+	pthread_mutex_lock(&taic_lock);
+	if (--taic_users == 0) {
+		munmap(taic, sizeof(Taic));
+		taic = NULL;
+	}
+	pthread_mutex_unlock(&taic_lock);
+}
+
+static LocalQueue* queue_at(uint64_t lq_base) {
+	return (LocalQueue*)lq_base;
+}
+
+uint64_t alloc_lq(void* taic_base, uint64_t os, uint64_t proc) {
+	Taic* controller = (Taic*)taic_base;
+	LocalQueue* queue;
+	size_t position;
+	int index;
+	int unallocated;
+
+	for (index = 0; index < TAIC_EMU_QUEUES; ++index) {
+		queue = &controller->queues[index];
+		unallocated = 0;
+		// clang-format off
+		if (atomic_compare_exchange_strong(
+					&queue->allocated, &unallocated, 1)) {
+			break;
+		}
+		// clang-format on
+	}
+	if (index == TAIC_EMU_QUEUES) {
+		terminate("Emulated TAIC has no free local queue\n");
+	}
+
+	queue->os = os;
+	queue->proc = proc;
+	atomic_store(&queue->process, 0);
+	atomic_store(&queue->thread, 0);
+	atomic_store(&queue->sender_count, 0);
+	atomic_store(&queue->receiver_count, 0);
+
+	// A slot is free for the producer whose position equals its sequence
+	atomic_store(&queue->enqueue, 0);
+	atomic_store(&queue->dequeue, 0);
+	for (position = 0; position < TAIC_EMU_SLOTS; ++position) {
+		atomic_store(&queue->slots[position].sequence, position);
+	}
+
+	set_uintr_enable(index);
+
+	return (uint64_t)queue;
+}
+
+void free_lq(void* taic_base, uint64_t lq_base) {
+	LocalQueue* queue = queue_at(lq_base);
+
+	atomic_store(&queue->thread, 0);
+	atomic_store(&queue->allocated, 0);
+}
+
+void lq_enq(uint64_t lq_base, uint64_t data) {
+	LocalQueue* queue = queue_at(lq_base);
+	size_t position = atomic_load_explicit(&queue->enqueue, memory_order_relaxed);
+	intptr_t difference;
+	Slot* slot;
+
+	for (;;) {
+		slot = &queue->slots[position & (TAIC_EMU_SLOTS - 1)];
+		// clang-format off
+		difference = (intptr_t)atomic_load_explicit(
+			&slot->sequence, memory_order_acquire) - (intptr_t)position;
+		// clang-format on
+
+		if (difference == 0) {
+			// clang-format off
+			if (atomic_compare_exchange_weak_explicit(
+						&queue->enqueue, &position, position + 1,
+						memory_order_relaxed, memory_order_relaxed)) {
+				break;
+			}
+			// clang-format on
+		} else if (difference < 0) {
+			// Full, the hardware drops the value as well
+			return;
+		} else {
+			position = atomic_load_explicit(&queue->enqueue, memory_order_relaxed);
+		}
+	}
+
+	slot->value = data;
+	atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+}
+
+uint64_t lq_deq(uint64_t lq_base) {
+	LocalQueue* queue = queue_at(lq_base);
+	size_t position = atomic_load_explicit(&queue->dequeue, memory_order_relaxed);
+	intptr_t difference;
+	uint64_t value;
+	Slot* slot;
+
+	// A user interrupt handler may dequeue on the owner's back, so
+	// consumers claim their slot like producers do
+	for (;;) {
+		slot = &queue->slots[position & (TAIC_EMU_SLOTS - 1)];
+		// clang-format off
+		difference = (intptr_t)atomic_load_explicit(
+			&slot->sequence, memory_order_acquire) - (intptr_t)(position + 1);
+		// clang-format on
+
+		if (difference == 0) {
+			// clang-format off
+			if (atomic_compare_exchange_weak_explicit(
+						&queue->dequeue, &position, position + 1,
+						memory_order_relaxed, memory_order_relaxed)) {
+				break;
+			}
+			// clang-format on
+		} else if (difference < 0) {
+			return 0;
+		} else {
+			position = atomic_load_explicit(&queue->dequeue, memory_order_relaxed);
+		}
+	}
+
+	value = slot->value;
+	// Free the slot for the producer one lap ahead
+	// clang-format off
+	atomic_store_explicit(
+		&slot->sequence, position + TAIC_EMU_SLOTS, memory_order_release);
+	// clang-format on
+
+	return value;
+}
+
+static Registration* find_registration(Registration* registrations,
+																			 atomic_int* count,
+																			 uint64_t os,
+																			 uint64_t proc) {
+	const int published = atomic_load_explicit(count, memory_order_acquire);
+	int index;
+
+	for (index = 0; index < published; ++index) {
+		if (registrations[index].os == os && registrations[index].proc == proc) {
+			return &registrations[index];
+		}
+	}
+
+	return NULL;
+}
+
+static Registration* add_registration(Registration* registrations,
+																			atomic_int* count,
+																			uint64_t os,
+																			uint64_t proc) {
+	Registration* registration;
+	int index;
+
+	// clang-format off
+	if ((registration = find_registration(
+					 registrations, count, os, proc)) != NULL) {
+		return registration;
+	}
+	// clang-format on
+
+	if ((index = atomic_load(count)) == TAIC_EMU_REGISTRATIONS) {
+		terminate("Emulated TAIC local queue has too many registrations\n");
+	}
+
+	registration = &registrations[index];
+	registration->os = os;
+	registration->proc = proc;
+	atomic_store(&registration->armed, 0);
+	atomic_store_explicit(count, index + 1, memory_order_release);
+
+	return registration;
+}
+
+void lq_register_sender(uint64_t lq_base, uint64_t recv_os, uint64_t recv_proc) {
+	LocalQueue* queue = queue_at(lq_base);
+
+	add_registration(queue->senders, &queue->sender_count, recv_os, recv_proc);
+}
+
+void lq_register_receiver(uint64_t lq_base,
+													uint64_t send_os,
+													uint64_t send_proc,
+													uint64_t handler) {
+	LocalQueue* queue = queue_at(lq_base);
+	Registration* registration;
+
+	// clang-format off
+	registration = add_registration(
+		queue->receivers, &queue->receiver_count, send_os, send_proc);
+	// clang-format on
+
+	// The handler is published by arming the registration
+	registration->handler = handler;
+	atomic_store_explicit(&registration->armed, 1, memory_order_release);
+}
+
+static void interrupt(LocalQueue* receiver, uint64_t handler) {
+	const int thread = atomic_load(&receiver->thread);
+
+	lq_enq((uint64_t)receiver, handler);
+
+	if (thread != 0) {
+		// clang-format off
+		if (syscall(SYS_tgkill, atomic_load(&receiver->process),
+								thread, TAIC_EMU_SIGNAL) == -1) {
+			throw("Error delivering emulated user interrupt");
+		}
+		// clang-format on
+	}
+}
+
+void lq_send_intr(uint64_t lq_base, uint64_t recv_os, uint64_t recv_proc) {
+	LocalQueue* sender = queue_at(lq_base);
+	Registration* registration;
+	LocalQueue* receiver;
+	int armed;
+	int index;
+
+	// Only registered receivers can be interrupted
+	// clang-format off
+	if (find_registration(
+				sender->senders, &sender->sender_count, recv_os, recv_proc) == NULL) {
+		return;
+	}
+	// clang-format on
+
+	for (index = 0; index < TAIC_EMU_QUEUES; ++index) {
+		receiver = &taic->queues[index];
+		if (!atomic_load(&receiver->allocated) || receiver->os != recv_os ||
+				receiver->proc != recv_proc) {
+			continue;
+		}
+
+		// clang-format off
+		registration = find_registration(receiver->receivers,
+																		 &receiver->receiver_count,
+																		 sender->os,
+																		 sender->proc);
+		// clang-format on
+
+		// A registration accepts one interrupt, others are lost
+		armed = 1;
+		if (registration != NULL &&
+				atomic_compare_exchange_strong(&registration->armed, &armed, 0)) {
+			interrupt(receiver, registration->handler);
+		}
+		return;
+	}
+}
+
+void set_uintr_enable(uint64_t lq_idx) {
+	interrupted_queue = &taic->queues[lq_idx];
+}
+
+static void deliver(int signal) {
+	if (interrupt_handler != NULL) {
+		interrupt_handler(NULL);
+	}
+}
+
+void setup_uintr(void* handler) {
+	struct sigaction action;
+
+	if (interrupted_queue == NULL) {
+		terminate("Allocate a local queue before setting up user interrupts\n");
+	}
+
+	interrupt_handler = handler;
+
+	memset(&action, 0, sizeof action);
+	action.sa_handler = deliver;
+	action.sa_flags = SA_RESTART;
+	sigemptyset(&action.sa_mask);
+	if (sigaction(TAIC_EMU_SIGNAL, &action, NULL) == -1) {
+		throw("Error installing user interrupt handler");
+	}
+
+	atomic_store(&interrupted_queue->process, getpid());
+	atomic_store(&interrupted_queue->thread, gettid());
+}
@@ -0,0 +1,62 @@
+#ifndef _TAIC_EMU_H
+#define _TAIC_EMU_H
+
+#include <stdint.h>
+
+/******************** DEFINITIONS ********************/
+
+// Local queues of the emulated controller
+#define TAIC_EMU_QUEUES 64
+
+// Values a local queue holds (a power of two), more are dropped
+#define TAIC_EMU_SLOTS 256
+
+// Senders and receivers one local queue can register
+#define TAIC_EMU_REGISTRATIONS 8
+
+// The registers the board saves for a user interrupt handler, which an
+// emulated handler does not get (it is called with NULL)
+struct __uintr_frame;
+
+/******************** INTERFACE ********************/
+
+// The same interface as the memory-mapped controller in taic.h, on a
+// controller in shared memory that delivers user interrupts as signals
+
+void* get_taic(int* mem_fd);
+
+void free_taic(void* taic_base, int* mem_fd);
+
+uint64_t alloc_lq(void* taic_base, uint64_t os, uint64_t proc);
+
+void free_lq(void* taic_base, uint64_t lq_base);
+
+void lq_enq(uint64_t lq_base, uint64_t data);
+
+// Returns the oldest value of the queue, or 0 if it is empty
+uint64_t lq_deq(uint64_t lq_base);
+
+void lq_register_sender(uint64_t lq_base, uint64_t recv_os, uint64_t recv_proc);
+
+// clang-format off
+void lq_register_receiver(
+		uint64_t lq_base, uint64_t send_os, uint64_t send_proc, uint64_t handler);
+// clang-format on
+
+void lq_send_intr(uint64_t lq_base, uint64_t recv_os, uint64_t recv_proc);
+
+// Lets the local queue of the calling thread interrupt it
+void set_uintr_enable(uint64_t lq_idx);
+
+/**
+ * Installs the user interrupt handler of the calling thread.
+ *
+ * From then on, an interrupt accepted by the local queue the thread allocated
+ * last is delivered as a real-time signal to the thread, whose handler calls
+ * the given one, instead of only being enqueued.
+ *
+ * \param handler A void (*)(struct __uintr_frame *).
+ */
+void setup_uintr(void* handler);
+
+#endif
@@ -0,0 +1,192 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "common/common.h"
+#include "common/ring.h"
+#include "uintr.h"
+#include "taic.h"
+
+uint64_t client_os = 1;
+uint64_t client_proc = 2;
+uint64_t server_os = 1;
+uint64_t server_proc = 1;
+uint64_t handler = 0x108;
+
+#define SERVER_TOKEN 0
+#define CLIENT_TOKEN 1
+
+volatile unsigned long is_inited[2];
+
+// The messages to the server and to the client. The interrupt only tells
+// the peer that the next message is in its ring, like taic-bi's token.
+Ring rings[2];
+
+void setup_rings(int size) {
+	const int slots = ring_slots(size);
+	const size_t bytes = ring_memory_size(size, slots);
+	char* memory;
+
+	// Anonymous memory is zero-filled, i.e. both rings are empty
+	// clang-format off
+	memory = mmap(NULL, 2 * bytes, PROT_READ | PROT_WRITE,
+								MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	// clang-format on
+	if (memory == MAP_FAILED) {
+		throw("Error mapping rings");
+	}
+
+	ring_setup(&rings[SERVER_TOKEN], memory, size, slots);
+	ring_setup(&rings[CLIENT_TOKEN], memory + bytes, size, slots);
+}
+
+void wait(unsigned int token, uint64_t lq_base) {
+	// Keep spinning until the notification is received
+	volatile uint64_t data = lq_deq(lq_base);
+	while (data != handler) {
+		data = lq_deq(lq_base);
+	}
+	if (token == SERVER_TOKEN) {
+		lq_register_receiver(lq_base, client_os, client_proc, handler);
+	} else {
+		lq_register_receiver(lq_base, server_os, server_proc, handler);
+	}
+	is_inited[token] = 1;
+}
+
+void notify(unsigned int token, uint64_t lq_base) {
+	// wait until the peer is inited
+	while (!is_inited[token]) {
+	}
+	is_inited[token] = 0;
+	if (token == SERVER_TOKEN) {
+		lq_send_intr(lq_base, server_os, server_proc);
+	} else {
+		lq_send_intr(lq_base, client_os, client_proc);
+	}
+}
+
+void send_message(unsigned int token,
+									uint64_t lq_base,
+									void* buffer,
+									int size) {
+	Ring* ring = &rings[token];
+
+	memcpy(ring_write_slot(ring), buffer, size);
+	ring_publish(ring);
+	notify(token, lq_base);
+}
+
+void receive_message(unsigned int token,
+										 uint64_t lq_base,
+										 void* buffer,
+										 int size) {
+	Ring* ring = &rings[token];
+
+	wait(token, lq_base);
+	memcpy(buffer, ring_read_slot(ring), size);
+	ring_release(ring);
+}
+
+// The client thread, whose CPU usage is reported next to the server's
+volatile pid_t client_thread = 0;
+
+void* client_communicate(void* arg) {
+	struct Arguments* args = (struct Arguments*)arg;
+	void* buffer = malloc(args->size);
+	uint64_t lq_base;
+	void* taic_base;
+	int mem_fd;
+	int loop;
+
+	client_thread = gettid();
+	pin_thread(args->client_cpu);
+
+	taic_base = get_taic(&mem_fd);
+	lq_base = alloc_lq(taic_base, client_os, client_proc);
+	lq_register_sender(lq_base, server_os, server_proc);
+	lq_register_receiver(lq_base, server_os, server_proc, handler);
+	is_inited[CLIENT_TOKEN] = 1;
+
+	for (loop = total_messages(args); loop > 0; --loop) {
+		receive_message(CLIENT_TOKEN, lq_base, buffer, args->size);
+		send_message(SERVER_TOKEN, lq_base, buffer, args->size);
+	}
+
+	free_lq(taic_base, lq_base);
+	free_taic(taic_base, &mem_fd);
+	free(buffer);
+
+	return NULL;
+}
+
+void server_communicate(struct Arguments* args) {
+	struct Benchmarks bench;
+	void* buffer = malloc(args->size);
+	uint64_t lq_base;
+	void* taic_base;
+	int mem_fd;
+	int message;
+
+	pin_thread(args->server_cpu);
+	memset(buffer, '*', args->size);
+
+	taic_base = get_taic(&mem_fd);
+	lq_base = alloc_lq(taic_base, server_os, server_proc);
+	lq_register_sender(lq_base, client_os, client_proc);
+	lq_register_receiver(lq_base, client_os, client_proc, handler);
+	is_inited[SERVER_TOKEN] = 1;
+	// The client thread publishes itself once it runs
+	while (client_thread == 0)
+		;
+	setup_benchmarks(&bench);
+	benchmarks_count_peer(&bench, client_thread);
+
+	for (message = total_messages(args); message > 0; --message) {
+		bench.single_start = now();
+
+		send_message(CLIENT_TOKEN, lq_base, buffer, args->size);
+		receive_message(SERVER_TOKEN, lq_base, buffer, args->size);
+
+		benchmark(&bench);
+	}
+
+	evaluate(&bench, args);
+	free_lq(taic_base, lq_base);
+	free_taic(taic_base, &mem_fd);
+	free(buffer);
+}
+
+void communicate(struct Arguments* args) {
+	pthread_t pt;
+
+	setup_rings(args->size);
+
+	// Create another thread
+	if (pthread_create(&pt, NULL, &client_communicate, args)) {
+		throw("Error creating sender thread");
+	}
+
+	server_communicate(args);
+
+	pthread_join(pt, NULL);
+}
+
+// Bidirectional with a payload: every message travels through a ring in
+// shared memory and is announced by a TAIC interrupt
+// 		server --> client
+//         \<------/
+int main(int argc, char* argv[]) {
+	struct Arguments args;
+
+	parse_arguments(&args, argc, argv);
+
+	communicate(&args);
+
+	return EXIT_SUCCESS;
+}
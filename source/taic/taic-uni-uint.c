@@ -1,3 +1,4 @@
+#define _GNU_SOURCE
 #include <pthread.h>
 #include <sched.h>
 #include <stdint.h>
@@ -7,10 +8,18 @@
 #include <unistd.h>
 
 #include "common/common.h"
+#include "common/results.h"
 #include "uintr.h"
 #include "taic.h"
 #include <assert.h>
 
+// Data words a local queue holds next to the interrupt, however deep it is
+#define MAX_BATCH 64
+
+// Data words are told apart from the handler value by their top bit
+#define DATA_WORD(message) ((1ULL << 63) | (uint64_t)(message))
+#define IS_DATA_WORD(value) (((value) >> 63) != 0)
+
 volatile unsigned long has_received = 0;
 volatile unsigned int received_count = 0;
 volatile unsigned int is_inited = 0;
@@ -24,34 +33,64 @@ uint64_t handler = 0x109;
 
 struct Benchmarks bench;
 
+// Interrupts taken and when the client started enqueuing the current batch
+volatile unsigned int interrupt_count = 0;
+volatile bench_t batch_start;
+
+// Messages the client enqueues per interrupt
+int batch = 1;
+
 void uintr_handler(struct __uintr_frame* ui_frame) {
-	volatile uint64_t data = lq_deq(server_lq_base);
-	// received notification
-	// assert(data == handler);
+	unsigned int drained = 0;
+	bench_t latency;
+	uint64_t data;
+
+	// Drain the whole batch, the interrupt is only raised once for it
+	while ((data = lq_deq(server_lq_base)) != 0) {
+		if (IS_DATA_WORD(data)) {
+			++drained;
+		}
+	}
+
+	// Every message of the batch waited from its start until now
+	latency = now() - batch_start;
+	while (drained-- > 0) {
+		benchmark_sample(&bench, latency);
+		received_count++;
+	}
+
 	lq_register_receiver(server_lq_base, client_os, client_proc, handler);
-	received_count++;
+	interrupt_count++;
 	is_inited = 1;
 	has_received = 1;
 }
 
+// The client thread, whose CPU usage is reported next to the server's
+volatile pid_t client_thread = 0;
+
 void *client_communicate(void *arg) {
 	struct Arguments* args = (struct Arguments*)arg;
+	client_thread = gettid();
+	pin_thread(args->client_cpu);
+
 	int mem_fd;
 	void* taic_base = get_taic(&mem_fd);
 	uint64_t lq_base = alloc_lq(taic_base, client_os, client_proc);
 	lq_register_sender(lq_base, server_os, server_proc);
 
-	int loop;
-	for (loop = args->count; loop > 0; --loop) {
+	int loop, message;
+	for (loop = total_messages(args); loop > 0; loop -= batch) {
 		while (!is_inited) { }
 		is_inited = 0;
 		has_received = 0;
-		// printf("Sending notification\n");
+		batch_start = now();
+		// Enqueue the batch, then notify the server once
+		for (message = 0; message < batch && message < loop; ++message) {
+			lq_enq(server_lq_base, DATA_WORD(loop - message));
+		}
 		lq_send_intr(lq_base, server_os, server_proc);
-		// Send notification
 		while (!has_received){
-			// Keep spinning until this notification is received.
-			// printf("Waiting for server receive notification\n");			
+			// Keep spinning until this batch is received.
 		}
 	}
 	free_lq(taic_base, lq_base);
@@ -61,20 +100,29 @@ void *client_communicate(void *arg) {
 }
 
 void server_communicate(struct Arguments* args) {
+	Results results;
+	pin_thread(args->server_cpu);
+
 	int mem_fd;
 	void* taic_base = get_taic(&mem_fd);
 	server_lq_base = alloc_lq(taic_base, server_os, server_proc);
 	setup_uintr(uintr_handler);
 	lq_register_receiver(server_lq_base, client_os, client_proc, handler);
 
+	// The client thread publishes itself once it runs
+	while (client_thread == 0)
+		;
 	setup_benchmarks(&bench);
+	benchmarks_count_peer(&bench, client_thread);
 	is_inited = 1;
 
-	while (received_count < args->count) {}
+	while (received_count < (unsigned int)total_messages(args)) {}
 
-	// The message size is always one (it's just a signal)
-	args->size = 1;
-	evaluate(&bench, args);
+	// Every message is a single data word
+	args->size = sizeof(uint64_t);
+	summarize(&bench, args, &results);
+	results.per_notification = received_count / (double)interrupt_count;
+	print_results(&results, args);
 	free_lq(taic_base, server_lq_base);
 	free_taic(taic_base, &mem_fd);
 }
@@ -90,16 +138,24 @@ void communicate(struct Arguments* args) {
 
 	server_communicate(args);
 
+	pthread_join(pt, NULL);
 }
 
-// unidirectional: client --> to server
+// unidirectional: client --> to server, --batch=<K> data words per interrupt
 int main(int argc, char* argv[]) {
 
 	struct Arguments args;
 
 	parse_arguments(&args, argc, argv);
 
+	if (option_value("batch", argc, argv) != NULL) {
+		batch = atoi(option_value("batch", argc, argv));
+		if (batch < 1 || batch > MAX_BATCH) {
+			terminate("Invalid batch, use 1 to 64 messages per interrupt\n");
+		}
+	}
+
 	communicate(&args);
 
 	return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
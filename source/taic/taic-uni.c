@@ -1,3 +1,4 @@
+#define _GNU_SOURCE
 #include <pthread.h>
 #include <sched.h>
 #include <stdint.h>
@@ -23,8 +24,14 @@ uint64_t server_proc = 1;
 struct Benchmarks bench;
 
 
+// The client thread, whose CPU usage is reported next to the server's
+volatile pid_t client_thread = 0;
+
 void *client_communicate(void *arg) {
 	struct Arguments* args = (struct Arguments*)arg;
+	client_thread = gettid();
+	pin_thread(args->client_cpu);
+
 	int mem_fd;
 	void* taic_base = get_taic(&mem_fd);
 	uint64_t lq_base = alloc_lq(taic_base, client_os, client_proc);
@@ -49,13 +56,19 @@ void *client_communicate(void *arg) {
 }
 
 void server_communicate(struct Arguments* args) {
+	pin_thread(args->server_cpu);
+
 	int mem_fd;
 	void* taic_base = get_taic(&mem_fd);
 	uint64_t lq_base = alloc_lq(taic_base, server_os, server_proc);
 	uint64_t handler = 0x108;
 	lq_register_receiver(lq_base, client_os, client_proc, handler);
 
+	// The client thread publishes itself once it runs
+	while (client_thread == 0)
+		;
 	setup_benchmarks(&bench);
+	benchmarks_count_peer(&bench, client_thread);
 	is_inited = 1;
 
 	while (received_count < args->count) {
@@ -96,6 +109,7 @@ int main(int argc, char* argv[]) {
 	struct Arguments args;
 
 	parse_arguments(&args, argc, argv);
+	reject_warmup(&args);
 
 	communicate(&args);
 
@@ -6,6 +6,8 @@
 #include <fcntl.h>
 #include "uintr.h"
 
+#if defined(__riscv)
+
 #define TAIC_BASE 0x1000000
 #define TAIC_SIZE 0x1000000
 #define LQ_NUM 8
@@ -89,4 +91,11 @@ void lq_send_intr(uint64_t lq_base, uint64_t recv_os, uint64_t recv_proc) {
     *send = recv_proc;
 }
 
-#endif
\ No newline at end of file
+#else
+
+// Without the board, the same interface is emulated in software
+#include "taic-emu.h"
+
+#endif /* __riscv */
+
+#endif
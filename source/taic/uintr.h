@@ -3,6 +3,8 @@
 
 #include <stdint.h>
 
+#if defined(__riscv)
+
 #ifdef __ASSEMBLER__
 #define __ASM_STR(x) x
 #else
@@ -179,4 +181,11 @@ void setup_uintr(void* handler) {
 	csr_set(CSR_UIE, MIE_USIE);
 }
 
-#endif
\ No newline at end of file
+#else
+
+// The emulated TAIC delivers user interrupts as signals instead
+#include "taic-emu.h"
+
+#endif /* __riscv */
+
+#endif
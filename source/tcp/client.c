@@ -2,6 +2,7 @@
 #include <fcntl.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -9,6 +10,9 @@
 
 #include "common/common.h"
 #include "common/sockets.h"
+#include "common/stream.h"
+#include "common/uring.h"
+#include "common/zerocopy.h"
 
 #define PORT "6969"
 #define HOST "localhost"
@@ -77,13 +81,25 @@ void cleanup(int descriptor, void *buffer) {
 	free(buffer);
 }
 
-void communicate(int descriptor, struct Arguments *args, int busy_waiting) {
+void communicate(int descriptor,
+								 struct Arguments *args,
+								 int busy_waiting,
+								 bool zerocopy) {
+	ZeroCopy sends;
+	int message;
+
 	// Buffer into which to read our data
 	void *buffer;
 
+	// Buffer to send back, which zero-copy sends must not overwrite
+	void *reply;
+
+	zerocopy_setup(&sends, descriptor, zerocopy);
 	buffer = malloc(args->size);
+	reply = zerocopy ? malloc(args->size) : buffer;
+	memset(reply, '*', args->size);
 
-	for (; args->count > 0; --args->count) {
+	for (message = total_messages(args); message > 0; --message) {
 		// Receive data
 		if (receive(descriptor, buffer, args->size, busy_waiting) == -1) {
 			throw("Error receiving data on client-side");
@@ -93,14 +109,34 @@ void communicate(int descriptor, struct Arguments *args, int busy_waiting) {
 		memset(buffer, '*', args->size);
 
 		// Send data back
-		if (send(descriptor, buffer, args->size, 0) == -1) {
+		if (zerocopy_send(&sends, reply, args->size) == -1) {
 			throw("Error sending data on client-side");
 		}
 	}
 
+	zerocopy_finish(&sends);
+	if (reply != buffer) free(reply);
 	cleanup(descriptor, buffer);
 }
 
+void stream_messages(int descriptor, struct Arguments *args) {
+	Descriptors descriptors = {descriptor, descriptor};
+	Channel channel;
+	int yes = 1;
+
+	// Nagle's algorithm would hold back small acknowledgements
+	// (and the last message of a batch) until the peer's ACK
+	// clang-format off
+	if (setsockopt(descriptor, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof yes) == -1) {
+		throw("Error disabling Nagle's algorithm");
+	}
+	// clang-format on
+
+	descriptor_channel(&channel, &descriptors);
+	stream_client(&channel, args);
+	cleanup(descriptor, NULL);
+}
+
 void get_server_information(struct addrinfo **server_info) {
 	// For system call return values
 	int return_code;
@@ -201,11 +237,25 @@ int main(int argc, char *argv[]) {
 	// Command-line arguments
 	struct Arguments args;
 
+	// Whether to send with MSG_ZEROCOPY
+	bool zerocopy;
+
 	busy_waiting = check_flag("busy", argc, argv);
 	parse_arguments(&args, argc, argv);
+	zerocopy = parse_zerocopy(&args, argc, argv);
 
 	socket_descriptor = create_socket(busy_waiting);
-	communicate(socket_descriptor, &args, busy_waiting);
+	if (check_flag("uring", argc, argv) || check_flag("sqpoll", argc, argv)) {
+		// clang-format off
+		uring_client(socket_descriptor, socket_descriptor, &args,
+								 check_flag("sqpoll", argc, argv));
+		// clang-format on
+		cleanup(socket_descriptor, NULL);
+	} else if (args.mode == MODE_PINGPONG) {
+		communicate(socket_descriptor, &args, busy_waiting, zerocopy);
+	} else {
+		stream_messages(socket_descriptor, &args);
+	}
 
 	return EXIT_SUCCESS;
 }
@@ -2,13 +2,18 @@
 #include <fcntl.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
 #include "common/common.h"
+#include "common/results.h"
 #include "common/sockets.h"
+#include "common/stream.h"
+#include "common/uring.h"
+#include "common/zerocopy.h"
 
 #define PORT "6969"
 #define HOST "localhost"
@@ -172,34 +177,71 @@ int accept_communication(int socket_descriptor, int busy_waiting) {
 	return connection;
 }
 
-void communicate(int descriptor, struct Arguments *args, int busy_waiting) {
+void communicate(int descriptor,
+								 struct Arguments *args,
+								 int busy_waiting,
+								 bool zerocopy) {
+	const int total = total_messages(args);
 	struct Benchmarks bench;
+	Results results;
+	ZeroCopy sends;
 	void *buffer;
+	void *reply;
 	int message;
+	int calls;
+	long receives = 0;
 
 	setup_benchmarks(&bench);
+	zerocopy_setup(&sends, descriptor, zerocopy);
 	buffer = malloc(args->size);
+	// The kernel reads a zero-copy send until it completes, so the reply
+	// must not overwrite it
+	reply = zerocopy ? malloc(args->size) : buffer;
 
-	for (message = 0; message < args->count; ++message) {
+	for (message = total; message > 0; --message) {
 		bench.single_start = now();
 
 		// Send to the client
-		if (send(descriptor, buffer, args->size, 0) == -1) {
+		if (zerocopy_send(&sends, buffer, args->size) == -1) {
 			throw("Error sending from server");
 		}
 
 		// Read from client
-		if (receive(descriptor, buffer, args->size, busy_waiting) == -1) {
+		if ((calls = receive(descriptor, reply, args->size, busy_waiting)) == -1) {
 			throw("Error receving from server");
 		}
+		receives += calls;
 
 		benchmark(&bench);
 	}
 
-	evaluate(&bench, args);
+	summarize(&bench, args, &results);
+	results.syscalls = (sends.calls + receives) / (double)total;
+	zerocopy_finish(&sends);
+	results.copied = zerocopy_copied(&sends);
+	print_results(&results, args);
+	if (reply != buffer) free(reply);
 	cleanup(descriptor, buffer);
 }
 
+void stream_messages(int connection, struct Arguments *args) {
+	Descriptors descriptors = {connection, connection};
+	Channel channel;
+	int yes = 1;
+
+	// Nagle's algorithm would hold back small acknowledgements
+	// (and the last message of a batch) until the peer's ACK
+	// clang-format off
+	if (setsockopt(connection, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof yes) == -1) {
+		throw("Error disabling Nagle's algorithm");
+	}
+	// clang-format on
+
+	descriptor_channel(&channel, &descriptors);
+	stream_server(&channel, args);
+	cleanup(connection, NULL);
+}
+
 void get_server_information(struct addrinfo **server_info) {
 	// For system call return values
 	int return_code;
@@ -311,13 +353,27 @@ int main(int argc, char *argv[]) {
 	// Command line arguments
 	struct Arguments args;
 
+	// Whether to send with MSG_ZEROCOPY
+	bool zerocopy;
+
 	busy_waiting = check_flag("busy", argc, argv);
 	parse_arguments(&args, argc, argv);
+	zerocopy = parse_zerocopy(&args, argc, argv);
 
 	socket_descriptor = create_socket();
 	connection = accept_communication(socket_descriptor, busy_waiting);
 
-	communicate(connection, &args, busy_waiting);
+	if (check_flag("uring", argc, argv) || check_flag("sqpoll", argc, argv)) {
+		// clang-format off
+		uring_server(connection, connection, &args,
+								 check_flag("sqpoll", argc, argv));
+		// clang-format on
+		cleanup(connection, NULL);
+	} else if (args.mode == MODE_PINGPONG) {
+		communicate(connection, &args, busy_waiting, zerocopy);
+	} else {
+		stream_messages(connection, &args);
+	}
 
 	return EXIT_SUCCESS;
 }
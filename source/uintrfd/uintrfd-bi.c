@@ -1,3 +1,4 @@
+#define _GNU_SOURCE
 #include <pthread.h>
 #include <sched.h>
 #include <stdint.h>
@@ -82,13 +83,19 @@ void setup_server(void) {
 	uipi_index[CLIENT_TOKEN] = uintr_register_sender(uintrfd_client);
 }
 
+// The client thread, whose CPU usage is reported next to the server's
+volatile pid_t client_thread = 0;
+
 void* client_communicate(void* arg) {
 	struct Arguments* args = (struct Arguments*)arg;
+	client_thread = gettid();
+	pin_thread(args->client_cpu);
+
 	int loop;
 
 	setup_client();
 
-	for (loop = args->count; loop > 0; --loop) {
+	for (loop = total_messages(args); loop > 0; --loop) {
 		uintrfd_wait(CLIENT_TOKEN);
 		uintrfd_notify(SERVER_TOKEN);
 	}
@@ -100,13 +107,23 @@ void server_communicate(struct Arguments* args) {
 	struct Benchmarks bench;
 	int message;
 
+	pin_thread(args->server_cpu);
+
 	setup_server();
 
+	// The client thread publishes itself once it runs
+	while (client_thread == 0)
+		;
 	setup_benchmarks(&bench);
+	benchmarks_count_peer(&bench, client_thread);
+
+	for (message = total_messages(args); message > 0; --message) {
+		bench.single_start = now();
 
-	for (message = 0; message < args->count; ++message) {
 		uintrfd_notify(CLIENT_TOKEN);
 		uintrfd_wait(SERVER_TOKEN);
+
+		benchmark(&bench);
 	}
 
 	// The message size is always one (it's just a signal)
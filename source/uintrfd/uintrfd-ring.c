@@ -0,0 +1,190 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "common/common.h"
+#include "common/ring.h"
+#include "uintr.h"
+
+#define SERVER_TOKEN 0
+#define CLIENT_TOKEN 1
+
+volatile unsigned long uintr_received[2];
+volatile int uintrfd_client;
+volatile int uintrfd_server;
+volatile int uipi_index[2];
+
+// The messages to the server and to the client. The interrupt only tells
+// the peer that the next message is in its ring, like uintrfd-bi's token.
+Ring rings[2];
+
+uint64_t uintr_handler(struct __uintr_frame* ui_frame, uint64_t irqs) {
+	int cnt = -1;
+	if (irqs == 0) {
+		printf("Error: No irqs!\n");
+		return 0;
+	}
+	while (irqs > 0) {
+		++cnt;
+		irqs >>= 1;
+	}
+	uintr_received[cnt] = 1;
+	return 0;
+}
+
+int setup_handler_with_vector(int vector) {
+	int fd;
+
+	if (__register_receiver(uintr_handler))
+		throw("Interrupt handler register error\n");
+
+	// Create a new uintrfd object and get the corresponding
+	// file descriptor.
+	fd = uintr_create_fd(vector);
+
+	if (fd < 0) throw("Interrupt vector registration error\n");
+
+	return fd;
+}
+
+void setup_rings(int size) {
+	const int slots = ring_slots(size);
+	const size_t bytes = ring_memory_size(size, slots);
+	char* memory;
+
+	// Anonymous memory is zero-filled, i.e. both rings are empty
+	// clang-format off
+	memory = mmap(NULL, 2 * bytes, PROT_READ | PROT_WRITE,
+								MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	// clang-format on
+	if (memory == MAP_FAILED) {
+		throw("Error mapping rings");
+	}
+
+	ring_setup(&rings[SERVER_TOKEN], memory, size, slots);
+	ring_setup(&rings[CLIENT_TOKEN], memory + bytes, size, slots);
+}
+
+void send_message(unsigned int token, void* buffer, int size) {
+	Ring* ring = &rings[token];
+
+	memcpy(ring_write_slot(ring), buffer, size);
+	ring_publish(ring);
+	uipi_send(uipi_index[token]);
+}
+
+void receive_message(unsigned int token, void* buffer, int size) {
+	Ring* ring = &rings[token];
+
+	// Keep spinning until the interrupt is received
+	while (!uintr_received[token])
+		;
+	uintr_received[token] = 0;
+
+	memcpy(buffer, ring_read_slot(ring), size);
+	ring_release(ring);
+}
+
+void setup_client(void) {
+	uintrfd_client = setup_handler_with_vector(CLIENT_TOKEN);
+
+	// Wait for the server to setup its FD.
+	while (!uintrfd_server)
+		;
+
+	uipi_index[SERVER_TOKEN] = uintr_register_sender(uintrfd_server);
+}
+
+void setup_server(void) {
+	uintrfd_server = setup_handler_with_vector(SERVER_TOKEN);
+
+	// Wait for the client to setup its FD.
+	while (!uintrfd_client)
+		;
+
+	uipi_index[CLIENT_TOKEN] = uintr_register_sender(uintrfd_client);
+}
+
+// The client thread, whose CPU usage is reported next to the server's
+volatile pid_t client_thread = 0;
+
+void* client_communicate(void* arg) {
+	struct Arguments* args = (struct Arguments*)arg;
+	void* buffer = malloc(args->size);
+	int loop;
+
+	client_thread = gettid();
+	pin_thread(args->client_cpu);
+
+	setup_client();
+
+	for (loop = total_messages(args); loop > 0; --loop) {
+		receive_message(CLIENT_TOKEN, buffer, args->size);
+		send_message(SERVER_TOKEN, buffer, args->size);
+	}
+
+	free(buffer);
+
+	return NULL;
+}
+
+void server_communicate(struct Arguments* args) {
+	struct Benchmarks bench;
+	void* buffer = malloc(args->size);
+	int message;
+
+	pin_thread(args->server_cpu);
+	memset(buffer, '*', args->size);
+
+	setup_server();
+
+	// The client thread publishes itself once it runs
+	while (client_thread == 0)
+		;
+	setup_benchmarks(&bench);
+	benchmarks_count_peer(&bench, client_thread);
+
+	for (message = total_messages(args); message > 0; --message) {
+		bench.single_start = now();
+
+		send_message(CLIENT_TOKEN, buffer, args->size);
+		receive_message(SERVER_TOKEN, buffer, args->size);
+
+		benchmark(&bench);
+	}
+
+	evaluate(&bench, args);
+	free(buffer);
+}
+
+void communicate(struct Arguments* args) {
+	pthread_t pt;
+
+	setup_rings(args->size);
+
+	// Create another thread
+	if (pthread_create(&pt, NULL, &client_communicate, args)) {
+		throw("Error creating sender thread");
+	}
+
+	server_communicate(args);
+
+	pthread_join(pt, NULL);
+}
+
+// Bidirectional with a payload: every message travels through a ring in
+// shared memory and is announced by a user interrupt
+int main(int argc, char* argv[]) {
+	struct Arguments args;
+
+	parse_arguments(&args, argc, argv);
+
+	communicate(&args);
+
+	return EXIT_SUCCESS;
+}
@@ -1,3 +1,4 @@
+#define _GNU_SOURCE
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -19,9 +20,15 @@ uint64_t uintr_handler(struct __uintr_frame *ui_frame, uint64_t irqs) {
   return 0;
 }
 
+// The client thread, whose CPU usage is reported next to the server's
+volatile pid_t client_thread = 0;
+
 void *client_communicate(void *arg) {
 
 	struct Arguments* args = (struct Arguments*)arg;
+	client_thread = gettid();
+	pin_thread(args->client_cpu);
+
 	int loop;
 
 	int uipi_index = uintr_register_sender(descriptor);
@@ -44,7 +51,12 @@ void *client_communicate(void *arg) {
 }
 
 void server_communicate(int descriptor, struct Arguments* args) {
+	pin_thread(args->server_cpu);
+	// The client thread publishes itself once it runs
+	while (client_thread == 0)
+		;
 	setup_benchmarks(&bench);
+	benchmarks_count_peer(&bench, client_thread);
 
 	while (uintr_count < args->count) {
 		//Keep spinning until all user interrupts are delivered.
@@ -83,6 +95,7 @@ int main(int argc, char* argv[]) {
 		throw("Interrupt vector allocation error\n");
 
 	parse_arguments(&args, argc, argv);
+	reject_warmup(&args);
 
 	communicate(descriptor, &args);
 
@@ -18,7 +18,7 @@ void communicate(void* socket, struct Arguments* args) {
 	setup_benchmarks(&bench);
 	void* buffer = malloc(args->size);
 
-	for (message = 0; message < args->count; ++message) {
+	for (message = total_messages(args); message > 0; --message) {
 		bench.single_start = now();
 
 		// Send data to the server (flags = 0)
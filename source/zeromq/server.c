@@ -7,11 +7,12 @@
 #include "common/common.h"
 
 void communicate(void* socket, struct Arguments* args) {
+	int message;
 	void* buffer;
 
 	buffer = malloc(args->size);
 
-	for (; args->count > 0; --args->count) {
+	for (message = total_messages(args); message > 0; --message) {
 
 		// Receive data from the client (flags = 0)
 		if (zmq_recv(socket, buffer, args->size, 0) < args->size) {